@@ -11,9 +11,38 @@
 #include <unordered_map>
 #include <string>
 #include <string_view>
+#include <chrono>
+#include <array>
+#include <memory_resource>
+#include <iterator>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <coroutine>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <sstream>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
 #include "SDL.h"
 #include "SDL_image.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
 std::string stof(Uint32 flags)
 {
 	std::string string{ "UNKOWN_FLAG" };
@@ -35,9 +64,11 @@ std::string stof(Uint32 flags)
 
 // Component defenitions
 
+// The texture is named by a view of an interned string (the names are string literals), so visuals are copied and staged without allocating
+
 struct VisualComponent
 {
-	std::string texture;
+	std::string_view texture;
 	SDL_Rect srcRect;
 	SDL_Rect dstRect;
 	SDL_RendererFlip flip;
@@ -105,7 +136,57 @@ struct AccumulatorComponent
 
 struct DebugComponent
 {
-	bool toggle;
+};
+
+struct TileComponent
+{
+};
+
+// Tags the visuals that are not tiles (the player, coins and movers), so they can be culled without walking the tiles
+
+struct SpriteComponent
+{
+};
+
+// An area that raises enter, stay and exit events for movers overlapping it
+
+struct TriggerComponent
+{
+	int x;
+	int y;
+	int w;
+	int h;
+};
+
+// Entities that walk toward the flow field's target
+
+struct ChaseComponent
+{
+	float speed;
+};
+
+// Tags entities whose position changed this tick. Cleared once the visuals have caught up
+
+struct MovedComponent
+{
+};
+
+struct CameraComponent
+{
+	int x;
+	int y;
+	int w;
+	int h;
+	entt::entity target;
+};
+
+// Plays a clip of Animation::Clips into the visual's srcRect. Kept small so the animated entities sweep through memory quickly
+
+struct AnimatorComponent
+{
+	std::uint16_t clip;
+	std::uint16_t frame;
+	std::uint32_t timer; // Ticks the current frame has been shown
 };
 
 struct Vector2D
@@ -114,6 +195,47 @@ struct Vector2D
 	int y;
 };
 
+// Scratch buffers for the debug overlay, one per color. They are cleared every frame but never shrunk, so once they have grown to fit the level the overlay allocates nothing
+
+struct DebugOverlay
+{
+	std::vector<SDL_Rect> colliders;
+	std::vector<SDL_Rect> collectables;
+	std::vector<SDL_Rect> xaxes;
+	std::vector<SDL_Rect> yaxes;
+	std::vector<SDL_Rect> bodies;
+	std::vector<SDL_Point> velocities; // Two points per line
+	std::vector<SDL_Rect> poolcapacities; // One row per component pool, see Memory::Report
+	std::vector<SDL_Rect> poolsizes;
+	std::vector<SDL_Rect> frameallocations; // A pixel per allocation during the last frame
+
+	void clear()
+	{
+		colliders.clear();
+		collectables.clear();
+		xaxes.clear();
+		yaxes.clear();
+		bodies.clear();
+		velocities.clear();
+		poolcapacities.clear();
+		poolsizes.clear();
+		frameallocations.clear();
+	}
+};
+
+// Returns the number of draw calls made (none for an empty list)
+
+int fillRects(SDL_Renderer* renderer, const std::vector<SDL_Rect>& rects, SDL_Color color)
+{
+	if (!rects.empty()) {
+		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+		return 1;
+	}
+
+	return 0;
+}
+
 // Collision detection function
 
 bool collideAt(SpatialComponent spt1, SpatialComponent spt2, Vector2D v = {0, 0}) 
@@ -134,188 +256,3347 @@ namespace Random {
 		return die(mt);
 	}
 
-	void randomizeCoinLocation(entt::registry& registry,  int tileswidth, int tilesheight, int tilescale) {
-		auto coinview{ registry.view<CollectableComponent>() };
+	void randomizeCoinLocation(entt::registry& registry, entt::entity coin, int tileswidth, int tilesheight, int tilescale) {
 		auto spatialview{ registry.view<SpatialComponent>() };
 
-		std::cout << tilescale << ' ' << tileswidth << ' ' << tilesheight << '\n';
-
-		for (auto coin : coinview) {
-			auto& collectable{ registry.get<CollectableComponent>(coin) };
+		auto& collectable{ registry.get<CollectableComponent>(coin) };
 
-			// generate a possible location
-			SpatialComponent coinSpawnpoint{ 0, 0, collectable.w, collectable.h};
+		// generate a possible location
+		SpatialComponent coinSpawnpoint{ 0, 0, collectable.w, collectable.h};
 
-			// test legality of location
-			bool isLegalPosition{ false };
+		// test legality of location
+		bool isLegalPosition{ false };
 
-			while (!isLegalPosition) {
-				isLegalPosition = true;
-				coinSpawnpoint.x = Random::get(0, tileswidth * 2) * tilescale / 2;
-				coinSpawnpoint.y = Random::get(0, tilesheight * 2) * tilescale / 2;
+		while (!isLegalPosition) {
+			isLegalPosition = true;
+			coinSpawnpoint.x = Random::get(0, tileswidth * 2) * tilescale / 2;
+			coinSpawnpoint.y = Random::get(0, tilesheight * 2) * tilescale / 2;
 
-				for (auto spatial : spatialview) {
-					auto& spatialdata{ registry.get<SpatialComponent>(spatial) };
-					if (collideAt(coinSpawnpoint, spatialdata)) {
-						isLegalPosition = false;
-						std::cout << "Coin(" << coinSpawnpoint.w << ", " << coinSpawnpoint.h << ") spawned at (" << coinSpawnpoint.x / tilescale << ", " << coinSpawnpoint.y / tilescale << "). Retrying...\n";
-						break;
-					}
-					else if ((tileswidth <= coinSpawnpoint.x / tilescale) || (tilesheight <= coinSpawnpoint.y / tilescale)) {
-						isLegalPosition = false;
-						std::cout << "Coin(" << coinSpawnpoint.w << ", " << coinSpawnpoint.h << ") spawned out of bounds. Retrying...\n";
-						break;
-					}
+			for (auto spatial : spatialview) {
+				auto& spatialdata{ registry.get<SpatialComponent>(spatial) };
+				if (collideAt(coinSpawnpoint, spatialdata)) {
+					isLegalPosition = false;
+					std::cout << "Coin(" << coinSpawnpoint.w << ", " << coinSpawnpoint.h << ") spawned at (" << coinSpawnpoint.x / tilescale << ", " << coinSpawnpoint.y / tilescale << "). Retrying...\n";
+					break;
+				}
+				else if ((tileswidth <= coinSpawnpoint.x / tilescale) || (tilesheight <= coinSpawnpoint.y / tilescale)) {
+					isLegalPosition = false;
+					std::cout << "Coin(" << coinSpawnpoint.w << ", " << coinSpawnpoint.h << ") spawned out of bounds. Retrying...\n";
+					break;
 				}
 			}
+		}
 
-			// spawn coin
-			collectable.x = coinSpawnpoint.x;
-			collectable.y = coinSpawnpoint.y;
+		// spawn coin
+		collectable.x = coinSpawnpoint.x;
+		collectable.y = coinSpawnpoint.y;
+		registry.emplace_or_replace<MovedComponent>(coin);
 
-			std::cout << "Coin(" << coinSpawnpoint.w << ", " << coinSpawnpoint.h << ") spawned at (" << coinSpawnpoint.x / tilescale << ", " << coinSpawnpoint.y / tilescale << ").\n";
+		// coins that are trigger volumes move their volume along
+		if (registry.all_of<TriggerComponent>(coin)) {
+			registry.replace<TriggerComponent>(coin, collectable.x, collectable.y, collectable.w, collectable.h);
 		}
+
+		std::cout << "Coin(" << coinSpawnpoint.w << ", " << coinSpawnpoint.h << ") spawned at (" << coinSpawnpoint.x / tilescale << ", " << coinSpawnpoint.y / tilescale << ").\n";
 	}
 }
 
-int main(int argc, char *argv[]) {
-	constexpr std::string_view linebreak{ "***********************************************\n" };
+// Contains the input layer. SDL events are drained into a compact per-tick action state once per frame, and the game reads only that state, so a recorded sequence of states replays the same input
 
-	try {
-		// <INIT>
-		std::cout << "<INIT>\n";
-		{
-			if (SDL_Init(SDL_INIT_EVERYTHING) == 0) {
-				std::cout << "SDL initialized...\n";
+namespace Input {
+	enum Action : std::size_t
+	{
+		Left,
+		Right,
+		Jump,
+		Debug,
+		Fullscreen,
+		Respawn,
+		ActionCount
+	};
+
+	using Bindings = std::array<SDL_Scancode, ActionCount>;
+
+	const std::array<std::string_view, ActionCount> actionnames{ "left", "right", "jump", "debug", "fullscreen", "respawn" };
+	const Bindings defaultbindings{ SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_SPACE, SDL_SCANCODE_F3, SDL_SCANCODE_F11, SDL_SCANCODE_C };
+
+	struct State
+	{
+		std::array<bool, ActionCount> held;
+		std::array<bool, ActionCount> pressed; // Went down during the last poll
+		int run; // Either -1 (left), 0 (still) or 1 (right). While both directions are held the one pressed first wins
+		bool quit;
+	};
+
+	void poll(State& state, const Bindings& bindings)
+	{
+		state.pressed.fill(false);
+
+		SDL_Event event{};
+
+		while (SDL_PollEvent(&event) != 0) {
+			if (event.type == SDL_QUIT) {
+				state.quit = true;
+				continue;
 			}
-			else {
-				std::cerr << "SDL_Init(): " << SDL_GetError() << '\n';
-				throw std::runtime_error("Init failed");
+
+			if ((event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) || (event.type == SDL_KEYDOWN && event.key.repeat)) {
+				continue;
 			}
 
-			if (IMG_Init(IMG_INIT_PNG) == IMG_INIT_PNG) {
-				std::cout << "SDL_image initialized...\n";
+			auto binding{ std::find(bindings.begin(), bindings.end(), event.key.keysym.scancode) };
+			if (binding == bindings.end()) {
+				continue;
 			}
-			else {
-				std::cerr << "IMG_Init(): " << IMG_GetError() << '\n';
-				throw std::runtime_error("Init failed");
+
+			auto action{ static_cast<Action>(binding - bindings.begin()) };
+			bool isDown{ event.type == SDL_KEYDOWN };
+
+			state.held[action] = isDown;
+			state.pressed[action] = state.pressed[action] || isDown;
+
+			if (action == Left) {
+				if (isDown) {
+					state.run = state.held[Right] ? state.run : -1;
+				}
+				else {
+					state.run = state.held[Right] ? 1 : 0;
+				}
+			}
+			else if (action == Right) {
+				if (isDown) {
+					state.run = state.held[Left] ? state.run : 1;
+				}
+				else {
+					state.run = state.held[Left] ? -1 : 0;
+				}
 			}
 		}
+	}
+}
 
-		std::cout << linebreak;
+// Config
 
-		// <CONFIG>
-		std::cout << "<CONFIG>\n";
+struct Config
+{
+	std::string name;
+	std::string level{ "assets/level_1.txt" };
+	std::string animations{ "assets/animations.txt" };
+	int tilesize;
+	int worldwidth;
+	int worldheight;
+	int worldscale;
+	int viewwidth;
+	int viewheight;
+	bool fused;
+	int jumpbuffer{ 6 }; // Ticks a jump pressed in the air stays queued for
+	double framebudget{ 16.0 }; // Milliseconds of work a frame may take, not counting the delay at its end
+	std::string incidentfile{ "incidents.txt" };
+	int incidentslots{ 16 };
+	Input::Bindings bindings{ Input::defaultbindings };
+	Uint32 windowflags;
+	Uint32 rendererflags;
+};
 
-		std::string name{};
-		int tilesize{};
-		int worldwidth{};
-		int worldheight{};
-		int worldscale{};
-		Uint32 windowflags{};
-		Uint32 rendererflags{};
-		
-		std::string configfile{ "assets/config.txt" };
+// A less than stallar way to read a config file. It reads each line and attemnpts to detect keywords with zero error checking
 
-		std::ifstream inFile(configfile);
-		if (inFile.is_open()) {
-			std::cout << "File opened...('" << configfile << "')\n";
+bool readConfig(const std::string& configfile, Config& config)
+{
+	std::ifstream inFile(configfile);
+	if (inFile.is_open()) {
+		std::cout << "File opened...('" << configfile << "')\n";
+	}
+	else {
+		std::cerr << "File failed to load...('" << configfile << "')\n";
+		return false;
+	}
+
+	std::string current{};
+	while (inFile >> current) {
+		if (current == "name:") {
+			inFile >> config.name;
 		}
-		else {
-			std::cerr << "File failed to load...('" << configfile << "')\n";
-			throw std::runtime_error("Config failed");
+		else if (current == "level:") {
+			inFile >> config.level;
+		}
+		else if (current == "animations:") {
+			inFile >> config.animations;
+		}
+		else if (current == "tilesize:") {
+			inFile >> config.tilesize;
+		}
+		else if (current == "worldwidth:") {
+			inFile >> config.worldwidth;
+		}
+		else if (current == "worldheight:") {
+			inFile >> config.worldheight;
 		}
+		else if (current == "worldscale:") {
+			inFile >> config.worldscale;
+		}
+		else if (current == "viewwidth:") {
+			inFile >> config.viewwidth;
+		}
+		else if (current == "viewheight:") {
+			inFile >> config.viewheight;
+		}
+		else if (current == "integrator:") {
+			inFile >> current;
+			config.fused = (current == "fused");
+		}
+		else if (current == "jumpbuffer:") {
+			inFile >> config.jumpbuffer;
+		}
+		else if (current == "framebudget:") {
+			inFile >> config.framebudget;
+		}
+		else if (current == "incidentfile:") {
+			inFile >> config.incidentfile;
+		}
+		else if (current == "incidentslots:") {
+			inFile >> config.incidentslots;
+		}
+		else if (current == "bindings:") {
+			while (inFile >> current) {
+				if (current == "<") {
+					continue;
+				}
+				else if (current == ">") {
+					break;
+				}
 
-		// A less than stallar way to read a config file. It reads each line and attemnpts to detect keywords with zero error checking
+				// Bindings come in pairs of an action and an SDL key name, e.g. 'jump Space'
+				std::string key{};
+				inFile >> key;
 
-		std::string current{};
-		while (inFile >> current) {
-			if (current == "name:") {
-				inFile >> name;
+				auto action{ std::find(Input::actionnames.begin(), Input::actionnames.end(), current) };
+				SDL_Scancode scancode{ SDL_GetScancodeFromName(key.c_str()) };
+
+				if (action != Input::actionnames.end() && scancode != SDL_SCANCODE_UNKNOWN) {
+					config.bindings[action - Input::actionnames.begin()] = scancode;
+				}
+				else {
+					std::cerr << "Unknown binding...('" << current << ' ' << key << "')\n";
+				}
 			}
-			else if (current == "tilesize:") {
-				inFile >> tilesize;
+		}
+		else if (current == "windowflags:") {
+			while (inFile >> current) {
+				if (current == "SDL_WINDOW_FULLSCREEN") {
+					config.windowflags += SDL_WINDOW_FULLSCREEN;
+				}
+				else if (current == "<") {
+					continue;
+				}
+				else if (current == ">") {
+					break;
+				}
 			}
-			else if (current == "worldwidth:") {
-				inFile >> worldwidth;
+		}
+		else if (current == "rendererflags:") {
+			while (inFile >> current) {
+				if (current == "SDL_RENDERER_ACCELERATED") {
+					config.rendererflags += SDL_RENDERER_ACCELERATED;
+				}
+				else if (current == "<") {
+					continue;
+				}
+				else if (current == ">") {
+					break;
+				}
 			}
-			else if (current == "worldheight:") {
-				inFile >> worldheight;
+		}
+	}
+
+	inFile.close();
+	std::cout << "File closed...('" << configfile << "')\n";
+
+	// The viewport defaults to the whole world, which is how levels that fit on one screen are shown
+
+	if (config.viewwidth <= 0) {
+		config.viewwidth = config.worldwidth;
+	}
+	if (config.viewheight <= 0) {
+		config.viewheight = config.worldheight;
+	}
+
+	return true;
+}
+
+// Contains functions and data related to levels. A level is kept as a grid of tile tokens (row-major, worldwidth * worldheight) next to a grid of the entities spawned from them
+
+namespace Level {
+	// Every tile, coin and mover is cut from this texture
+
+	constexpr std::string_view texture{ "assets/texture.png" };
+
+	struct TileType
+	{
+		SDL_Point filepoint;
+		bool isCollidable;
+	};
+
+	const std::unordered_map<std::string, TileType> tiletypes{
+		{ "w",   { { 2, 1 }, true } },
+		{ "wl",  { { 3, 1 }, true } },
+		{ "wr",  { { 1, 1 }, true } },
+		{ "wd",  { { 2, 0 }, true } },
+		{ "wu",  { { 2, 2 }, true } },
+		{ "wld", { { 3, 0 }, true } },
+		{ "wrd", { { 1, 0 }, true } },
+		{ "wlu", { { 3, 2 }, true } },
+		{ "wru", { { 1, 2 }, true } },
+		{ "vld", { { 1, 4 }, true } },
+		{ "vrd", { { 2, 4 }, true } },
+		{ "vlu", { { 1, 3 }, true } },
+		{ "vru", { { 2, 3 }, true } },
+		{ "s",   { { 5, 1 }, false } },
+		{ "sc",  { { 5, 0 }, false } },
+		{ "sb",  { { 4, 0 }, false } },
+		{ "stl", { { 4, 1 }, false } },
+		{ "str", { { 6, 1 }, false } },
+		{ "s1",  { { 6, 0 }, false } },
+		{ "s2",  { { 4, 2 }, false } },
+		{ "s3",  { { 5, 2 }, false } },
+		{ "s4",  { { 6, 2 }, false } },
+		{ "wf",  { { 3, 3 }, true } },
+		{ "wbu", { { 3, 5 }, true } },
+		{ "wbd", { { 3, 4 }, true } },
+		{ "wbl", { { 2, 5 }, true } },
+		{ "wbr", { { 1, 5 }, true } },
+		{ "c",   { { 5, 1 }, false } }, // Coin spawn, drawn as sky
+		{ "m",   { { 5, 1 }, false } }, // Mover spawn, drawn as sky
+	};
+
+	// Reads the tokens of a level file into the grid. Unknown tokens are skipped, tokens past the last cell are ignored and cells past the end of the file are left empty
+
+	bool read(const std::string& levelfile, int worldwidth, int worldheight, std::vector<std::string>& tiles)
+	{
+		std::ifstream inFile(levelfile);
+		if (inFile.is_open()) {
+			std::cout << "File opened...('" << levelfile << "')\n";
+		}
+		else {
+			std::cerr << "File failed to load...('" << levelfile << "')\n";
+			return false;
+		}
+
+		tiles.assign(static_cast<std::size_t>(worldwidth) * worldheight, std::string{});
+
+		std::size_t cell{ 0 };
+		std::string current{};
+		while (cell < tiles.size() && inFile >> current) {
+			if (tiletypes.count(current)) {
+				tiles[cell++] = current;
 			}
-			else if (current == "worldscale:") {
-				inFile >> worldscale;
+		}
+
+		inFile.close();
+		std::cout << "File closed...('" << levelfile << "')\n";
+
+		return true;
+	}
+
+	VisualComponent tileVisual(const TileType& type, int tilecol, int tilerow, const Config& config)
+	{
+		SDL_Rect srcRect{ type.filepoint.x * config.tilesize, type.filepoint.y * config.tilesize, config.tilesize, config.tilesize };
+		SDL_Rect dstRect{ tilecol * config.tilesize * config.worldscale, tilerow * config.tilesize * config.worldscale, config.tilesize * config.worldscale, config.tilesize * config.worldscale };
+
+		return VisualComponent{ texture, srcRect, dstRect, SDL_FLIP_NONE };
+	}
+
+	entt::entity spawnTile(entt::registry& registry, const std::string& token, int tilecol, int tilerow, const Config& config)
+	{
+		const auto& type{ tiletypes.at(token) };
+		auto tile{ registry.create() };
+
+		const auto& visual{ registry.emplace<VisualComponent>(tile, tileVisual(type, tilecol, tilerow, config)) };
+		registry.emplace<TileComponent>(tile);
+
+		if (type.isCollidable) {
+			int x{ visual.dstRect.x };
+			int y{ visual.dstRect.y };
+			int w{ visual.dstRect.w };
+			int h{ visual.dstRect.h };
+
+			registry.emplace<SpatialComponent>(tile, x, y, w, h);
+			registry.emplace<DebugComponent>(tile);
+		}
+
+		return tile;
+	}
+
+	// Brings the spawned tiles in line with a new grid. Only cells whose token changed are destroyed and respawned, everything else is left untouched. Returns the number of patched cells and lists them in changed
+
+	int patch(entt::registry& registry, std::vector<entt::entity>& entities, std::vector<std::string>& tiles, const std::vector<std::string>& next, const Config& config, std::vector<std::size_t>& changed)
+	{
+		if (entities.size() != next.size()) {
+			entities.resize(next.size(), entt::null);
+			tiles.resize(next.size());
+		}
+
+		int patched{ 0 };
+		changed.clear();
+
+		for (std::size_t cell{ 0 }; cell < next.size(); ++cell) {
+			if (tiles[cell] == next[cell] && (next[cell].empty() || entities[cell] != entt::null)) {
+				continue;
 			}
-			else if (current == "windowflags:") {
-				while (inFile >> current) {
-					if (current == "SDL_WINDOW_FULLSCREEN") {
-						windowflags += SDL_WINDOW_FULLSCREEN;
-					}
-					else if (current == "<") {
-						continue;
-					}
-					else if (current == ">") {
-						break;
-					}
-				}
+
+			if (entities[cell] != entt::null) {
+				registry.destroy(entities[cell]);
+				entities[cell] = entt::null;
 			}
-			else if (current == "rendererflags:") {
-				while (inFile >> current) {
-					if (current == "SDL_RENDERER_ACCELERATED") {
-						rendererflags += SDL_RENDERER_ACCELERATED;
-					}
-					else if (current == "<") {
-						continue;
-					}
-					else if (current == ">") {
-						break;
-					}
-				}
+
+			if (!next[cell].empty()) {
+				int tilecol{ static_cast<int>(cell % config.worldwidth) };
+				int tilerow{ static_cast<int>(cell / config.worldwidth) };
+				entities[cell] = spawnTile(registry, next[cell], tilecol, tilerow, config);
 			}
+
+			tiles[cell] = next[cell];
+			changed.push_back(cell);
+			++patched;
 		}
 
-		inFile.close();
-		std::cout << "File closed...('" << configfile << "')\n";
+		return patched;
+	}
 
-		std::cout << "name\t\t==\t" << name << '\n'
-			<< "tilesize\t==\t" << tilesize << '\n'
-			<< "worldwidth\t==\t" << worldwidth << '\n'
-			<< "worldheight\t==\t" << worldheight << '\n'
-			<< "worldscale\t==\t" << worldscale << '\n';
+	entt::entity spawnCoin(entt::registry& registry, int x, int y, const Config& config)
+	{
+		int coinwidth{ 4 * config.worldscale };
+		int coinheight{ 4 * config.worldscale };
+		int coinSpriteX{ 0 * config.tilesize / 2 };
+		int coinSpriteY{ 12 * config.tilesize / 2 };
 
-		std::cout << "windowflags\t==\t";
-		if (windowflags && SDL_WINDOW_FULLSCREEN) {
-			std::cout << "SDL_WINDOW_FULLSCREEN\n";
+		auto coin{ registry.create() };
+		registry.emplace<VisualComponent>(coin, texture, SDL_Rect{ coinSpriteX, coinSpriteY, config.tilesize / 2, config.tilesize / 2 }, SDL_Rect{ x, y, config.tilesize * config.worldscale / 2, config.tilesize * config.worldscale / 2 });
+		registry.emplace<CollectableComponent>(coin, x, y, coinwidth, coinheight);
+		registry.emplace<TriggerComponent>(coin, x, y, coinwidth, coinheight);
+		registry.emplace<SpriteComponent>(coin);
+		registry.emplace<DebugComponent>(coin);
+
+		return coin;
+	}
+
+	// A body without input. It looks like the player and chases whatever the flow field leads to
+
+	entt::entity spawnMover(entt::registry& registry, int x, int y, const Config& config)
+	{
+		auto mover{ registry.create() };
+		registry.emplace<VisualComponent>(mover, texture, SDL_Rect{ 4 * config.tilesize, 7 * config.tilesize, config.tilesize / 2, config.tilesize }, SDL_Rect{ x, y, config.tilesize * config.worldscale / 2, config.tilesize * config.worldscale }, SDL_FLIP_NONE);
+		registry.emplace<SpatialComponent>(mover, x, y, 4 * config.worldscale, 8 * config.worldscale);
+		registry.emplace<VelocityComponent>(mover);
+		registry.emplace<AccelerationComponent>(mover);
+		registry.emplace<GravityComponent>(mover, 0.5f);
+		registry.emplace<MoveComponent>(mover);
+		registry.emplace<ChaseComponent>(mover, 2.0f);
+		registry.emplace<SpriteComponent>(mover);
+		registry.emplace<DebugComponent>(mover);
+
+		return mover;
+	}
+
+	// Which cells of the grid block movement, one byte per cell. Kept next to the token grid for queries that walk the level cell by cell
+
+	struct CollisionGrid
+	{
+		int columns;
+		int rows;
+		int cellsize; // In pixels
+		std::vector<std::uint8_t> solid;
+
+		bool isSolid(int col, int row) const
+		{
+			return solid[static_cast<std::size_t>(row) * columns + col] != 0;
 		}
-		else {
-			std::cout << '\n';
+	};
+
+	CollisionGrid collisionGrid(const std::vector<std::string>& tiles, const Config& config)
+	{
+		CollisionGrid grid{ config.worldwidth, config.worldheight, config.tilesize * config.worldscale, std::vector<std::uint8_t>(tiles.size(), 0) };
+
+		for (std::size_t cell{ 0 }; cell < tiles.size(); ++cell) {
+			grid.solid[cell] = !tiles[cell].empty() && tiletypes.at(tiles[cell]).isCollidable;
 		}
 
-		std::cout << "rendererflags\t==\t";
-		if (rendererflags && SDL_RENDERER_ACCELERATED) {
-			std::cout << "SDL_RENDERER_ACCELERATED\n";
+		return grid;
+	}
+
+	// Brings the grid in line with the cells Level::patch changed. A grid of another shape is rebuilt whole
+
+	void patchCollisionGrid(CollisionGrid& grid, const std::vector<std::string>& tiles, const std::vector<std::size_t>& cells, const Config& config)
+	{
+		if (grid.solid.size() != tiles.size() || grid.cellsize != config.tilesize * config.worldscale) {
+			grid = collisionGrid(tiles, config);
+			return;
 		}
-		else {
-			std::cout << "NONE\n";
+
+		for (auto cell : cells) {
+			grid.solid[cell] = !tiles[cell].empty() && tiletypes.at(tiles[cell]).isCollidable;
 		}
+	}
 
-		std::cout << linebreak;
+	// Spawns the coins and movers placed in the grid and adds them to spawned. Done when a level is loaded from scratch, a patching hot reload treats their cells as plain sky
+
+	void spawnEntities(entt::registry& registry, const std::vector<std::string>& tiles, const Config& config, std::vector<entt::entity>& spawned)
+	{
+		int tilepixels{ config.tilesize * config.worldscale };
+
+		for (std::size_t cell{ 0 }; cell < tiles.size(); ++cell) {
+			int x{ static_cast<int>(cell % config.worldwidth) * tilepixels };
+			int y{ static_cast<int>(cell / config.worldwidth) * tilepixels };
+
+			if (tiles[cell] == "c") {
+				spawned.push_back(spawnCoin(registry, x + tilepixels / 4, y + tilepixels / 4, config));
+			}
+			else if (tiles[cell] == "m") {
+				spawned.push_back(spawnMover(registry, x, y, config));
+			}
+		}
+	}
+
+	// Destroys the coins and movers spawnEntities placed, before a level is loaded from scratch again
+
+	void despawnEntities(entt::registry& registry, std::vector<entt::entity>& spawned)
+	{
+		for (auto entity : spawned) {
+			if (registry.valid(entity)) {
+				registry.destroy(entity);
+			}
+		}
+
+		spawned.clear();
+	}
+
+	// Destroys every spawned tile, used when the grid itself changes shape
+
+	void clear(entt::registry& registry, std::vector<entt::entity>& entities, std::vector<std::string>& tiles)
+	{
+		for (auto entity : entities) {
+			if (entity != entt::null) {
+				registry.destroy(entity);
+			}
+		}
+
+		entities.clear();
+		tiles.clear();
+	}
+
+	// Spawns a whole grid from scratch. The tile count is known up front, so every pool is reserved once and entities and components are created in bulk ranges instead of tile by tile
+
+	void load(entt::registry& registry, std::vector<entt::entity>& entities, std::vector<std::string>& tiles, std::vector<std::string>&& next, const Config& config)
+	{
+		clear(registry, entities, tiles);
+
+		std::size_t count{ 0 };
+		std::size_t collidables{ 0 };
+
+		for (const auto& token : next) {
+			if (!token.empty()) {
+				++count;
+				collidables += tiletypes.at(token).isCollidable;
+			}
+		}
+
+		// The staging buffers only live for this call, so they are all carved out of one arena sized to fit them
+
+		std::pmr::monotonic_buffer_resource arena{ count * (sizeof(entt::entity) + sizeof(VisualComponent)) + collidables * (sizeof(entt::entity) + sizeof(SpatialComponent)) + 256 };
+		std::pmr::vector<entt::entity> spawned(count, entt::entity{}, &arena);
+		std::pmr::vector<VisualComponent> visuals{ &arena };
+		std::pmr::vector<entt::entity> solids{ &arena };
+		std::pmr::vector<SpatialComponent> spatials{ &arena };
+
+		visuals.reserve(count);
+		solids.reserve(collidables);
+		spatials.reserve(collidables);
+
+		registry.storage<VisualComponent>().reserve(registry.storage<VisualComponent>().size() + count);
+		registry.storage<TileComponent>().reserve(registry.storage<TileComponent>().size() + count);
+		registry.storage<SpatialComponent>().reserve(registry.storage<SpatialComponent>().size() + collidables);
+		registry.storage<DebugComponent>().reserve(registry.storage<DebugComponent>().size() + collidables);
+
+		registry.create(spawned.begin(), spawned.end());
+
+		// The parsed grid becomes the level's grid, nothing is copied
+
+		entities.assign(next.size(), entt::null);
+		tiles = std::move(next);
+
+		auto tile{ spawned.begin() };
+
+		for (std::size_t cell{ 0 }; cell < tiles.size(); ++cell) {
+			if (tiles[cell].empty()) {
+				continue;
+			}
+
+			const auto& type{ tiletypes.at(tiles[cell]) };
+			int tilecol{ static_cast<int>(cell % config.worldwidth) };
+			int tilerow{ static_cast<int>(cell / config.worldwidth) };
+
+			const auto& visual{ visuals.emplace_back(tileVisual(type, tilecol, tilerow, config)) };
+
+			if (type.isCollidable) {
+				solids.push_back(*tile);
+				spatials.push_back(SpatialComponent{ visual.dstRect.x, visual.dstRect.y, visual.dstRect.w, visual.dstRect.h });
+			}
+
+			entities[cell] = *tile++;
+		}
+
+		registry.insert<VisualComponent>(spawned.begin(), spawned.end(), std::make_move_iterator(visuals.begin()));
+		registry.insert<TileComponent>(spawned.begin(), spawned.end());
+		registry.insert<SpatialComponent>(solids.begin(), solids.end(), spatials.begin());
+		registry.insert<DebugComponent>(solids.begin(), solids.end());
+	}
+}
+
+// Contains the procedural level generator. Levels are generated from a seed into the same token grid the level loader reads, so any size of world can be written out and loaded like a hand-made one
+
+namespace Generator {
+	// Ground follows a random walk, with two tiles thick platforms floating above it. Solid cells are then given the wall piece matching their neighbours
+
+	std::vector<std::string> generate(int width, int height, unsigned int seed, double coindensity, double moverdensity)
+	{
+		std::mt19937 mt{ seed };
+		std::uniform_real_distribution<double> chance{ 0.0, 1.0 };
+
+		auto roll{ [&](int min, int max) {
+			std::uniform_int_distribution die{ min, max };
+			return die(mt);
+		} };
+
+		std::vector<char> solid(static_cast<std::size_t>(width) * height, 0);
+		auto at{ [&](int col, int row) -> char& { return solid[static_cast<std::size_t>(row) * width + col]; } };
+
+		// Ground
+
+		std::vector<int> ground(width);
+		int surface{ height * 2 / 3 };
+
+		for (int col{ 0 }; col < width; ++col) {
+			if (chance(mt) < 0.25) {
+				surface = std::clamp(surface + roll(-1, 1), std::max(1, height / 3), std::max(1, height - 2));
+			}
+
+			ground[col] = surface;
+
+			for (int row{ surface }; row < height; ++row) {
+				at(col, row) = 1;
+			}
+		}
+
+		// Platforms, roughly one per 48 cells of sky
+
+		int platforms{ width * height / 3 / 48 };
+
+		for (int i{ 0 }; i < platforms && height > 6; ++i) {
+			int length{ roll(3, 8) };
+			int col{ roll(0, std::max(0, width - length)) };
+			int row{ roll(2, std::max(2, ground[col] - 4)) };
+
+			for (int x{ col }; x < std::min(width, col + length); ++x) {
+				if (row + 1 < ground[x] - 2) {
+					at(x, row) = 1;
+					at(x, row + 1) = 1;
+				}
+			}
+		}
+
+		// Out of bounds counts as solid below and to the sides, and as sky above, so the edges of the world look cut off rather than walled in
+
+		auto isSolid{ [&](int col, int row) {
+			if (row < 0) {
+				return false;
+			}
+			if (row >= height) {
+				return true;
+			}
+			return at(std::clamp(col, 0, width - 1), row) != 0;
+		} };
+
+		std::vector<std::string> tiles(solid.size());
+
+		for (int row{ 0 }; row < height; ++row) {
+			for (int col{ 0 }; col < width; ++col) {
+				std::string& tile{ tiles[static_cast<std::size_t>(row) * width + col] };
+
+				if (!at(col, row)) {
+					if (row + 1 < height && at(col, row + 1) && chance(mt) < moverdensity) {
+						tile = "m";
+					}
+					else if (chance(mt) < coindensity) {
+						tile = "c";
+					}
+					else if (chance(mt) < 0.05) {
+						constexpr std::array<std::string_view, 4> decorations{ "s1", "s2", "s3", "s4" };
+						tile = decorations[roll(0, 3)];
+					}
+					else {
+						tile = "s";
+					}
+
+					continue;
+				}
+
+				// Pieces are named after the directions the wall continues in
+
+				bool l{ isSolid(col - 1, row) };
+				bool r{ isSolid(col + 1, row) };
+				bool u{ isSolid(col, row - 1) };
+				bool d{ isSolid(col, row + 1) };
+
+				if (l && r && u && d) {
+					if (!isSolid(col + 1, row + 1)) {
+						tile = "vlu";
+					}
+					else if (!isSolid(col - 1, row + 1)) {
+						tile = "vru";
+					}
+					else if (!isSolid(col + 1, row - 1)) {
+						tile = "vld";
+					}
+					else if (!isSolid(col - 1, row - 1)) {
+						tile = "vrd";
+					}
+					else {
+						tile = "w";
+					}
+				}
+				else if (l && r && d) tile = "wd";
+				else if (l && r && u) tile = "wu";
+				else if (u && d && r) tile = "wr";
+				else if (u && d && l) tile = "wl";
+				else if (r && d) tile = "wrd";
+				else if (l && d) tile = "wld";
+				else if (r && u) tile = "wru";
+				else if (l && u) tile = "wlu";
+				else if (l && r) tile = "wd";
+				else if (u && d) tile = "wr";
+				else if (d) tile = "wbd";
+				else if (u) tile = "wbu";
+				else if (l) tile = "wbl";
+				else if (r) tile = "wbr";
+				else tile = "wf";
+			}
+		}
+
+		return tiles;
+	}
+
+	bool write(const std::string& levelfile, const std::vector<std::string>& tiles, int width)
+	{
+		std::ofstream outFile(levelfile);
+		if (!outFile.is_open()) {
+			std::cerr << "File failed to open...('" << levelfile << "')\n";
+			return false;
+		}
+
+		for (std::size_t cell{ 0 }; cell < tiles.size(); ++cell) {
+			outFile << tiles[cell] << (((cell + 1) % width) ? ' ' : '\n');
+		}
+
+		return true;
+	}
+}
+
+// Contains ray queries against the level's collision grid. Rays walk the grid cell by cell (DDA), so a query costs as many steps as cells it crosses no matter how many entities there are
+
+namespace Raycast {
+	struct Ray
+	{
+		float x; // Origin in world pixels
+		float y;
+		float dx; // Direction, does not need to be normalized
+		float dy;
+		float length; // How far to look, in world pixels
+	};
+
+	struct Hit
+	{
+		bool isHit;
+		int col; // The solid tile that was hit
+		int row;
+		float x; // Where the ray entered that tile
+		float y;
+		int normalx; // Face of the tile that was hit. Both are 0 when the ray starts inside a solid
+		int normaly;
+		float distance;
+	};
+
+	Hit cast(const Level::CollisionGrid& grid, const Ray& ray)
+	{
+		Hit hit{ false, -1, -1, 0.0f, 0.0f, 0, 0, 0.0f };
+
+		float magnitude{ std::sqrt(ray.dx * ray.dx + ray.dy * ray.dy) };
+		if (magnitude == 0.0f || grid.columns <= 0 || grid.rows <= 0) {
+			return hit;
+		}
+
+		float dx{ ray.dx / magnitude };
+		float dy{ ray.dy / magnitude };
+		float size{ static_cast<float>(grid.cellsize) };
+
+		int col{ static_cast<int>(std::floor(ray.x / size)) };
+		int row{ static_cast<int>(std::floor(ray.y / size)) };
+
+		int stepx{ (dx > 0) - (dx < 0) };
+		int stepy{ (dy > 0) - (dy < 0) };
+
+		// Distance along the ray to the next vertical and horizontal cell border, and between two of them
+
+		constexpr float infinity{ std::numeric_limits<float>::infinity() };
+		float deltax{ stepx ? size / std::abs(dx) : infinity };
+		float deltay{ stepy ? size / std::abs(dy) : infinity };
+		float nextx{ stepx ? ((stepx > 0 ? (col + 1) * size : col * size) - ray.x) / dx : infinity };
+		float nexty{ stepy ? ((stepy > 0 ? (row + 1) * size : row * size) - ray.y) / dy : infinity };
+
+		float distance{ 0.0f };
+		int normalx{ 0 };
+		int normaly{ 0 };
+
+		while (distance <= ray.length) {
+			if (col >= 0 && col < grid.columns && row >= 0 && row < grid.rows) {
+				if (grid.isSolid(col, row)) {
+					hit = Hit{ true, col, row, ray.x + dx * distance, ray.y + dy * distance, normalx, normaly, distance };
+					break;
+				}
+			}
+			else if ((col < 0 && stepx <= 0) || (col >= grid.columns && stepx >= 0) || (row < 0 && stepy <= 0) || (row >= grid.rows && stepy >= 0)) {
+				break; // Outside the grid and heading away from it
+			}
+
+			if (nextx < nexty) {
+				distance = nextx;
+				nextx += deltax;
+				col += stepx;
+				normalx = -stepx;
+				normaly = 0;
+			}
+			else {
+				distance = nexty;
+				nexty += deltay;
+				row += stepy;
+				normalx = 0;
+				normaly = -stepy;
+			}
+		}
+
+		return hit;
+	}
+
+	// True if nothing solid lies between the two points
+
+	bool lineOfSight(const Level::CollisionGrid& grid, float x1, float y1, float x2, float y2)
+	{
+		float dx{ x2 - x1 };
+		float dy{ y2 - y1 };
+
+		return !cast(grid, Ray{ x1, y1, dx, dy, std::sqrt(dx * dx + dy * dy) }).isHit;
+	}
+
+	// Threads kept alive between calls to castAll. The calling thread always takes a share of the work, so a pool of one starts no threads at all
+
+	class Workers
+	{
+	public:
+		explicit Workers(unsigned int count)
+		{
+			// Threads already started have to be stopped if starting the next one fails, or their destructors would terminate the program
+			try {
+				for (unsigned int part{ 1 }; part < count; ++part) {
+					threads.emplace_back(&Workers::work, this, part);
+				}
+			}
+			catch (...) {
+				stop();
+				throw;
+			}
+		}
+
+		Workers(const Workers&) = delete;
+		Workers& operator=(const Workers&) = delete;
+
+		~Workers()
+		{
+			stop();
+		}
+
+		unsigned int size() const
+		{
+			return static_cast<unsigned int>(threads.size()) + 1;
+		}
+
+		// Splits [0, count) into one contiguous chunk per thread and calls function(first, last) for each. Returns once every chunk is done, rethrowing the first exception any of them threw
+
+		template <typename Function>
+		void run(std::size_t count, Function&& function)
+		{
+			std::size_t chunk{ (count + size() - 1) / size() };
+
+			auto range{ [&](unsigned int part) {
+				function(std::min(count, part * chunk), std::min(count, (part + 1) * chunk));
+			} };
+
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				task = &range;
+				invoke = [](const void* context, unsigned int part) { (*static_cast<const decltype(range)*>(context))(part); };
+				pending = threads.size();
+				++generation;
+			}
+			wake.notify_all();
+
+			// The workers refer to range, so they must be done before this returns, even if the share of this thread threw
+			std::exception_ptr failure{};
+			try {
+				range(0);
+			}
+			catch (...) {
+				failure = std::current_exception();
+			}
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			done.wait(lock, [&]() { return pending == 0; });
+
+			if (!failure) {
+				failure = error;
+			}
+			error = nullptr;
+
+			if (failure) {
+				std::rethrow_exception(failure);
+			}
+		}
+
+	private:
+		void work(unsigned int part)
+		{
+			std::size_t seen{ 0 };
+			std::unique_lock<std::mutex> lock{ mutex };
+
+			while (true) {
+				wake.wait(lock, [&]() { return isStopping || generation != seen; });
+				if (isStopping) {
+					return;
+				}
+				seen = generation;
+				lock.unlock();
+
+				std::exception_ptr failure{};
+				try {
+					invoke(task, part);
+				}
+				catch (...) {
+					failure = std::current_exception();
+				}
+
+				lock.lock();
+				if (failure && !error) {
+					error = failure;
+				}
+				if (--pending == 0) {
+					done.notify_one();
+				}
+			}
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				isStopping = true;
+			}
+			wake.notify_all();
+
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			threads.clear();
+		}
+
+		std::vector<std::thread> threads{};
+		std::mutex mutex{};
+		std::condition_variable wake{};
+		std::condition_variable done{};
+		const void* task{ nullptr };
+		void (*invoke)(const void*, unsigned int) { nullptr };
+		std::size_t pending{ 0 }; // Workers still busy with the current run
+		std::size_t generation{ 0 }; // Counts runs, so a worker can tell a new one from a spurious wake up
+		std::exception_ptr error{};
+		bool isStopping{ false };
+	};
+
+	// Casts every ray, writing hits[i] for rays[i]
+
+	void castAll(const Level::CollisionGrid& grid, const std::vector<Ray>& rays, std::vector<Hit>& hits)
+	{
+		hits.resize(rays.size());
+
+		for (std::size_t i{ 0 }; i < rays.size(); ++i) {
+			hits[i] = cast(grid, rays[i]);
+		}
+	}
+
+	// The same, with the rays split into contiguous chunks over the workers, which only read the grid. Too few rays to be worth waking them are cast on the calling thread
+
+	void castAll(const Level::CollisionGrid& grid, const std::vector<Ray>& rays, std::vector<Hit>& hits, Workers& workers)
+	{
+		if (workers.size() == 1 || rays.size() < 256 * static_cast<std::size_t>(workers.size())) {
+			castAll(grid, rays, hits);
+			return;
+		}
+
+		hits.resize(rays.size());
+
+		workers.run(rays.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i{ first }; i < last; ++i) {
+				hits[i] = cast(grid, rays[i]);
+			}
+		});
+	}
+}
+
+// Contains pathfinding over the level's collision grid. A flow field stores, for every open cell, how far the target is and which neighbour to step to, so any number of agents find their next step with a single lookup
+
+namespace Pathfinding {
+	// Steps are 4-way over open cells. Gravity and jump arcs are not modeled, the field only tells an agent which way the target lies along open space
+
+	class FlowField
+	{
+	public:
+		// Searches breadth-first out from the target until every open seeker cell has been expanded, so the seekers and their neighbours all know their distance, and stops there. The search is kept between calls. It starts over only when the target entered another cell or the grid was rebuilt, and otherwise resumes where it stopped if a seeker has moved beyond it. Returns whether it searched
+
+		bool update(const Level::CollisionGrid& grid, int col, int row, const std::vector<SDL_Point>& seekers)
+		{
+			bool isRestart{ !isValid || col != targetcol || row != targetrow };
+
+			if (isRestart) {
+				restart(grid, col, row);
+			}
+			else if (head == frontier.size()) {
+				return false;
+			}
+
+			auto want{ [&](int wantedcol, int wantedrow) {
+				if (contains(wantedcol, wantedrow) && !grid.isSolid(wantedcol, wantedrow) && !isExpanded(wantedcol, wantedrow)) {
+					pending.push_back(SDL_Point{ wantedcol, wantedrow });
+				}
+			} };
+
+			pending.clear();
+			for (const auto& seeker : seekers) {
+				// A seeker stuck in a solid cell is steered by its side neighbours (see horizontalStep), so those are searched for instead
+				if (contains(seeker.x, seeker.y) && grid.isSolid(seeker.x, seeker.y)) {
+					want(seeker.x - 1, seeker.y);
+					want(seeker.x + 1, seeker.y);
+				}
+				else {
+					want(seeker.x, seeker.y);
+				}
+			}
+
+			if (pending.empty()) {
+				return isRestart;
+			}
+
+			// Whole rings are expanded at a time, so a seeker is expanded exactly when its distance is below the next ring's. A seeker the target can not reach keeps the search going until it runs out
+			while (head < frontier.size() && !pending.empty()) {
+				int ring{ distances[frontier[head]] };
+
+				while (head < frontier.size() && distances[frontier[head]] == ring) {
+					expand(grid, frontier[head++]);
+				}
+
+				std::erase_if(pending, [&](const SDL_Point& seeker) { return isExpanded(seeker.x, seeker.y); });
+			}
+
+			return true;
+		}
+
+		// The same for the whole field, every cell the target can reach
+
+		bool update(const Level::CollisionGrid& grid, int col, int row)
+		{
+			bool isRestart{ !isValid || col != targetcol || row != targetrow };
+
+			if (isRestart) {
+				restart(grid, col, row);
+			}
+			else if (head == frontier.size()) {
+				return false;
+			}
+
+			while (head < frontier.size()) {
+				expand(grid, frontier[head++]);
+			}
+
+			return true;
+		}
+
+		// Forces the next update to recompute, for when the grid itself changed
+
+		void invalidate()
+		{
+			isValid = false;
+		}
+
+		// The step (one of the four unit directions) that leads toward the target. (0, 0) at the target and where it can not be reached (or the search has not got to yet)
+
+		SDL_Point step(int col, int row) const
+		{
+			return contains(col, row) ? offsets[directions[index(col, row)]] : offsets[0];
+		}
+
+		// Steps to the target, -1 where it can not be reached (or the search has not got to yet)
+
+		int distance(int col, int row) const
+		{
+			return contains(col, row) ? distances[index(col, row)] : unreachable;
+		}
+
+		// The horizontal direction (-1, 0 or 1) for an agent that can only walk, since gravity does the rest. Where the field points up or down, the side neighbour closer to the target is taken, and a tie goes toward the target's column
+
+		int horizontalStep(int col, int row) const
+		{
+			SDL_Point direct{ step(col, row) };
+
+			if (direct.x != 0) {
+				return direct.x;
+			}
+
+			int left{ distance(col - 1, row) };
+			int right{ distance(col + 1, row) };
+			int toward{ (targetcol > col) - (targetcol < col) };
+
+			if (left == unreachable && right == unreachable) {
+				return distance(col, row) == unreachable ? 0 : toward;
+			}
+			if (left == unreachable) {
+				return 1;
+			}
+			if (right == unreachable) {
+				return -1;
+			}
+
+			return left < right ? -1 : right < left ? 1 : toward;
+		}
+
+	private:
+		static constexpr int unreachable{ -1 };
+		static constexpr std::array<SDL_Point, 5> offsets{ SDL_Point{ 0, 0 }, SDL_Point{ -1, 0 }, SDL_Point{ 1, 0 }, SDL_Point{ 0, -1 }, SDL_Point{ 0, 1 } };
+
+		bool contains(int col, int row) const
+		{
+			return col >= 0 && col < columns && row >= 0 && row < rows;
+		}
+
+		std::size_t index(int col, int row) const
+		{
+			return static_cast<std::size_t>(row) * columns + col;
+		}
+
+		bool isExpanded(int col, int row) const
+		{
+			int reached{ distances[index(col, row)] };
+
+			return reached != unreachable && (head == frontier.size() || reached < distances[frontier[head]]);
+		}
+
+		// Clears the last search and queues the target. Only the cells that search reached were written to, so only those are cleared unless the grid changed size
+
+		void restart(const Level::CollisionGrid& grid, int col, int row)
+		{
+			if (columns != grid.columns || rows != grid.rows) {
+				columns = grid.columns;
+				rows = grid.rows;
+
+				std::size_t size{ static_cast<std::size_t>(columns) * rows };
+				distances.assign(size, unreachable);
+				directions.assign(size, 0);
+			}
+			else {
+				for (int cell : frontier) {
+					distances[cell] = unreachable;
+					directions[cell] = 0;
+				}
+			}
+
+			targetcol = col;
+			targetrow = row;
+			isValid = true;
+			frontier.clear();
+			head = 0;
+
+			if (contains(col, row) && !grid.isSolid(col, row)) {
+				frontier.push_back(static_cast<int>(index(col, row)));
+				distances[index(col, row)] = 0;
+			}
+		}
+
+		void expand(const Level::CollisionGrid& grid, int cell)
+		{
+			int cellcol{ cell % columns };
+			int cellrow{ cell / columns };
+
+			for (std::uint8_t direction{ 1 }; direction < offsets.size(); ++direction) {
+				int nextcol{ cellcol - offsets[direction].x };
+				int nextrow{ cellrow - offsets[direction].y };
+
+				if (contains(nextcol, nextrow) && !grid.isSolid(nextcol, nextrow) && distances[index(nextcol, nextrow)] == unreachable) {
+					// The neighbour lies opposite the step, so taking that step from it leads back to this cell
+					distances[index(nextcol, nextrow)] = distances[cell] + 1;
+					directions[index(nextcol, nextrow)] = direction;
+					frontier.push_back(static_cast<int>(index(nextcol, nextrow)));
+				}
+			}
+		}
+
+		int columns{ 0 };
+		int rows{ 0 };
+		int targetcol{ -1 };
+		int targetrow{ -1 };
+		bool isValid{ false };
+		std::vector<int> distances{};
+		std::vector<std::uint8_t> directions{}; // Index into offsets
+		std::vector<int> frontier{}; // The search queue, which also records every cell the search reached
+		std::size_t head{ 0 }; // The next cell in frontier to expand
+		std::vector<SDL_Point> pending{}; // Seekers the search has not expanded yet
+	};
+}
+
+// Sprite animation. Clips are runs of frames in one flat table and are loaded from a data file like this (rects in texture pixels, durations in ticks):
+//
+//	clip: water
+//	frame: 48 0 8 8 10
+//	frame: 32 16 8 8 10
+//	tile: s1 water 0
+//	tile: s2 water 1
+//
+// 'tile:' lines make every tile of a token play a clip, starting at the given frame so neighbouring tiles can be out of step. The clips named coin, idle and run are played by coins and by the player standing and running
+
+namespace Animation {
+	struct Frame
+	{
+		SDL_Rect srcRect;
+		std::uint32_t ticks;
+	};
+
+	struct Clip
+	{
+		std::uint32_t first; // Index of the first frame in Clips::frames
+		std::uint32_t count;
+	};
+
+	struct Binding
+	{
+		std::uint16_t clip;
+		std::uint16_t frame;
+	};
+
+	struct Clips
+	{
+		std::vector<Frame> frames;
+		std::vector<Clip> clips;
+		std::unordered_map<std::string, std::uint16_t> names;
+		std::unordered_map<std::string, Binding> tiles;
+
+		// Returns -1 if there is no clip by that name
+
+		int find(const std::string& name) const
+		{
+			auto found{ names.find(name) };
+			return found != names.end() ? found->second : -1;
+		}
+	};
+
+	bool read(const std::string& animationfile, Clips& clips)
+	{
+		std::ifstream inFile(animationfile);
+		if (inFile.is_open()) {
+			std::cout << "File opened...('" << animationfile << "')\n";
+		}
+		else {
+			std::cerr << "File failed to load...('" << animationfile << "')\n";
+			return false;
+		}
+
+		Clips next{};
+		bool isValid{ true };
+
+		std::string current{};
+		while (isValid && inFile >> current) {
+			if (current == "clip:") {
+				inFile >> current;
+				next.names[current] = static_cast<std::uint16_t>(next.clips.size());
+				next.clips.push_back(Clip{ static_cast<std::uint32_t>(next.frames.size()), 0 });
+			}
+			else if (current == "frame:") {
+				Frame frame{};
+				inFile >> frame.srcRect.x >> frame.srcRect.y >> frame.srcRect.w >> frame.srcRect.h >> frame.ticks;
+
+				isValid = !next.clips.empty() && frame.ticks > 0;
+
+				if (isValid) {
+					next.frames.push_back(frame);
+					++next.clips.back().count;
+				}
+			}
+			else if (current == "tile:") {
+				std::string token{};
+				std::string clip{};
+				int frame{ 0 };
+				inFile >> token >> clip >> frame;
+
+				isValid = next.names.count(clip) > 0 && frame >= 0;
+
+				if (isValid) {
+					next.tiles[token] = Binding{ next.names.at(clip), static_cast<std::uint16_t>(frame) };
+				}
+			}
+		}
+
+		inFile.close();
+		std::cout << "File closed...('" << animationfile << "')\n";
+
+		// Every clip needs a frame, the animation pass never checks
+
+		for (const auto& clip : next.clips) {
+			isValid = isValid && clip.count > 0;
+		}
+
+		if (!isValid || inFile.bad()) {
+			std::cerr << "File has an invalid clip table...('" << animationfile << "')\n";
+			return false;
+		}
+
+		clips = std::move(next);
+		return true;
+	}
+
+	// The animated entities with their visuals, both packed in the same order so one pass walks two arrays front to back
+
+	auto animated(entt::registry& registry)
+	{
+		return registry.group<AnimatorComponent, VisualComponent>();
+	}
+
+	// Switches to a clip from its first frame. Playing the clip that is already playing does nothing
+
+	void play(AnimatorComponent& animator, int clip)
+	{
+		if (clip >= 0 && animator.clip != clip) {
+			animator = AnimatorComponent{ static_cast<std::uint16_t>(clip), 0, 0 };
+		}
+	}
+
+	// Gives a tile the animator its token is bound to, unless it has one already
+
+	void attachTile(entt::registry& registry, entt::entity tile, const std::string& token, const Clips& clips)
+	{
+		auto binding{ clips.tiles.find(token) };
+
+		if (binding != clips.tiles.end() && tile != entt::null && !registry.all_of<AnimatorComponent>(tile)) {
+			const auto& clip{ clips.clips[binding->second.clip] };
+			registry.emplace<AnimatorComponent>(tile, binding->second.clip, static_cast<std::uint16_t>(binding->second.frame % clip.count), 0u);
+		}
+	}
+
+	// Gives animators to the tiles of the cells Level::patch changed, the rest of the grid kept theirs
+
+	void attach(entt::registry& registry, const std::vector<entt::entity>& entities, const std::vector<std::string>& tiles, const std::vector<std::size_t>& cells, const Clips& clips)
+	{
+		if (!clips.tiles.empty()) {
+			for (auto cell : cells) {
+				attachTile(registry, entities[cell], tiles[cell], clips);
+			}
+		}
+	}
+
+	// Gives animators to the tiles, coins and player that have a clip and no animator yet. Done after a level is loaded from scratch, since its entities come without one
+
+	void attach(entt::registry& registry, const std::vector<entt::entity>& entities, const std::vector<std::string>& tiles, const Clips& clips)
+	{
+		if (!clips.tiles.empty()) {
+			for (std::size_t cell{ 0 }; cell < tiles.size(); ++cell) {
+				attachTile(registry, entities[cell], tiles[cell], clips);
+			}
+		}
+
+		int coinclip{ clips.find("coin") };
+		int idleclip{ clips.find("idle") };
+
+		if (coinclip >= 0) {
+			auto coins{ registry.view<CollectableComponent, VisualComponent>(entt::exclude<AnimatorComponent>) };
+
+			for (auto entity : coins) {
+				registry.emplace<AnimatorComponent>(entity, static_cast<std::uint16_t>(coinclip), std::uint16_t{ 0 }, 0u);
+			}
+		}
+
+		if (idleclip >= 0) {
+			auto runners{ registry.view<RunComponent, VisualComponent>(entt::exclude<AnimatorComponent>) };
+
+			for (auto entity : runners) {
+				registry.emplace<AnimatorComponent>(entity, static_cast<std::uint16_t>(idleclip), std::uint16_t{ 0 }, 0u);
+			}
+		}
+	}
+
+	// Advances every animator by one tick and writes the current frame to its visual
+
+	void update(entt::registry& registry, const Clips& clips)
+	{
+		for (auto [entity, animator, visual] : animated(registry).each()) {
+			const auto& clip{ clips.clips[animator.clip] };
+
+			if (++animator.timer >= clips.frames[clip.first + animator.frame].ticks) {
+				animator.timer = 0;
+				animator.frame = static_cast<std::uint16_t>((animator.frame + 1) % clip.count);
+			}
+
+			visual.srcRect = clips.frames[clip.first + animator.frame].srcRect;
+		}
+	}
+}
+
+// Watches a directory for files that were written to or moved into it, so assets can be reloaded while running. Only implemented on Linux (inotify), elsewhere it never reports anything
+
+class AssetWatcher
+{
+public:
+	// An empty directory watches nothing
+
+	explicit AssetWatcher(const std::string& directory) : directory{ directory }
+	{
+#ifdef __linux__
+		if (directory.empty()) {
+			return;
+		}
+
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd != -1 && inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+			close(fd);
+			fd = -1;
+		}
+#endif
+	}
+
+	~AssetWatcher()
+	{
+#ifdef __linux__
+		if (fd != -1) {
+			close(fd);
+		}
+#endif
+	}
+
+	AssetWatcher(const AssetWatcher&) = delete;
+	AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+	bool isWatching() const
+	{
+		return fd != -1;
+	}
+
+	// Returns the paths of every file changed since the last call, each path at most once
+
+	std::vector<std::string> poll()
+	{
+		std::vector<std::string> changed{};
+
+#ifdef __linux__
+		if (fd == -1) {
+			return changed;
+		}
+
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length{};
+
+		while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+			for (char* pointer{ buffer }; pointer < buffer + length; ) {
+				const auto* event{ reinterpret_cast<const inotify_event*>(pointer) };
+
+				if (event->len) {
+					std::string path{ directory + '/' + event->name };
+					if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+						changed.push_back(path);
+					}
+				}
+
+				pointer += sizeof(inotify_event) + event->len;
+			}
+		}
+#endif
+
+		return changed;
+	}
+
+private:
+	std::string directory;
+	int fd{ -1 };
+};
+
+// Contains the per-tick physics systems. Movers (Velocity + Move + Spatial) live in an owning group, which keeps their components packed and in the same order at the front of each pool, so the systems stream through them with each() instead of looking every component up by entity
+
+namespace Physics {
+	auto bodies(entt::registry& registry)
+	{
+		return registry.group<VelocityComponent, MoveComponent, SpatialComponent>();
+	}
+
+	// Bodies that also fall and accelerate. The group is nested in the one above, so its members come first in all five pools
+
+	auto integrables(entt::registry& registry)
+	{
+		return registry.group<VelocityComponent, MoveComponent, SpatialComponent, GravityComponent, AccelerationComponent>();
+	}
+
+	void applyGravity(entt::registry& registry)
+	{
+		auto view{ registry.view<VelocityComponent, GravityComponent>() };
+
+		for (auto [entity, velocity, gravity] : view.each()) {
+			velocity.y += gravity.g;
+		}
+	}
+
+	void applyAcceleration(entt::registry& registry)
+	{
+		auto view{ registry.view<VelocityComponent, AccelerationComponent>() };
+
+		for (auto [entity, velocity, acceleration] : view.each()) {
+			velocity.x += acceleration.x;
+			velocity.y += acceleration.y;
+
+			if (velocity.x > 16) {
+				velocity.x = 16;
+			}
+			if (velocity.y > 16) {
+				velocity.y = 16;
+			}
+		}
+	}
+
+	// Sub-pixel accumulation of one body's velocity into whole pixels to move
+
+	void accumulate(const VelocityComponent& velocity, MoveComponent& move)
+	{
+		move.xr += velocity.x;
+		move.yr += velocity.y;
+
+		move.x = static_cast<int>(std::round(move.xr));
+		move.y = static_cast<int>(std::round(move.yr));
+
+		move.xr -= move.x;
+		move.yr -= move.y;
+	}
+
+	void applyVelocity(entt::registry& registry)
+	{
+		for (auto [entity, velocity, move, spatial] : bodies(registry).each()) {
+			accumulate(velocity, move);
+		}
+	}
+
+	// Gravity, acceleration, clamping and sub-pixel accumulation fused into one pass over count integrable bodies stored as plain arrays. Every step is done in the same order as the separate systems so both paths give bit-identical results. With SSE2 four bodies are done per step: the interleaved fields are transposed into one register each, and rounding half away from zero is done by truncating and correcting by the fraction left over, which matches std::round for every value that fits an int. The remaining bodies go one at a time
+
+	void integrateSpan(VelocityComponent* __restrict velocities, MoveComponent* __restrict moves, const GravityComponent* __restrict gravities, const AccelerationComponent* __restrict accelerations, std::size_t count)
+	{
+		std::size_t i{ 0 };
+
+#if defined(__SSE2__) || defined(_M_X64)
+		const __m128 limit{ _mm_set1_ps(16.0f) };
+		const __m128 half{ _mm_set1_ps(0.5f) };
+		const __m128 negativehalf{ _mm_set1_ps(-0.5f) };
+
+		auto roundhalfaway{ [&](__m128 value) {
+			__m128i truncated{ _mm_cvttps_epi32(value) };
+			__m128 fraction{ _mm_sub_ps(value, _mm_cvtepi32_ps(truncated)) };
+			__m128i up{ _mm_castps_si128(_mm_cmpge_ps(fraction, half)) };
+			__m128i down{ _mm_castps_si128(_mm_cmple_ps(fraction, negativehalf)) };
+
+			return _mm_add_epi32(_mm_sub_epi32(truncated, up), down); // The masks are -1 where set
+		} };
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 velocity01{ _mm_loadu_ps(&velocities[i].x) };
+			__m128 velocity23{ _mm_loadu_ps(&velocities[i + 2].x) };
+			__m128 acceleration01{ _mm_loadu_ps(&accelerations[i].x) };
+			__m128 acceleration23{ _mm_loadu_ps(&accelerations[i + 2].x) };
+
+			__m128 vx{ _mm_add_ps(_mm_shuffle_ps(velocity01, velocity23, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(acceleration01, acceleration23, _MM_SHUFFLE(2, 0, 2, 0))) };
+			__m128 vy{ _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(velocity01, velocity23, _MM_SHUFFLE(3, 1, 3, 1)), _mm_loadu_ps(&gravities[i].g)), _mm_shuffle_ps(acceleration01, acceleration23, _MM_SHUFFLE(3, 1, 3, 1))) };
+
+			// The limit goes first so a NaN passes through like it does in std::min
+			vx = _mm_min_ps(limit, vx);
+			vy = _mm_min_ps(limit, vy);
+
+			_mm_storeu_ps(&velocities[i].x, _mm_unpacklo_ps(vx, vy));
+			_mm_storeu_ps(&velocities[i + 2].x, _mm_unpackhi_ps(vx, vy));
+
+			__m128 move0{ _mm_loadu_ps(reinterpret_cast<const float*>(&moves[i])) };
+			__m128 move1{ _mm_loadu_ps(reinterpret_cast<const float*>(&moves[i + 1])) };
+			__m128 move2{ _mm_loadu_ps(reinterpret_cast<const float*>(&moves[i + 2])) };
+			__m128 move3{ _mm_loadu_ps(reinterpret_cast<const float*>(&moves[i + 3])) };
+			_MM_TRANSPOSE4_PS(move0, move1, move2, move3);
+
+			__m128 xr{ _mm_add_ps(move2, vx) };
+			__m128 yr{ _mm_add_ps(move3, vy) };
+			__m128i x{ roundhalfaway(xr) };
+			__m128i y{ roundhalfaway(yr) };
+
+			move0 = _mm_castsi128_ps(x);
+			move1 = _mm_castsi128_ps(y);
+			move2 = _mm_sub_ps(xr, _mm_cvtepi32_ps(x));
+			move3 = _mm_sub_ps(yr, _mm_cvtepi32_ps(y));
+			_MM_TRANSPOSE4_PS(move0, move1, move2, move3);
+
+			_mm_storeu_ps(reinterpret_cast<float*>(&moves[i]), move0);
+			_mm_storeu_ps(reinterpret_cast<float*>(&moves[i + 1]), move1);
+			_mm_storeu_ps(reinterpret_cast<float*>(&moves[i + 2]), move2);
+			_mm_storeu_ps(reinterpret_cast<float*>(&moves[i + 3]), move3);
+		}
+#endif
+
+		for (; i < count; ++i) {
+			float vx{ velocities[i].x + accelerations[i].x };
+			float vy{ (velocities[i].y + gravities[i].g) + accelerations[i].y };
+
+			vx = std::min(vx, 16.0f);
+			vy = std::min(vy, 16.0f);
+
+			velocities[i].x = vx;
+			velocities[i].y = vy;
+
+			float xr{ moves[i].xr + vx };
+			float yr{ moves[i].yr + vy };
+			float x{ std::round(xr) };
+			float y{ std::round(yr) };
+
+			moves[i].x = static_cast<int>(x);
+			moves[i].y = static_cast<int>(y);
+			moves[i].xr = xr - x;
+			moves[i].yr = yr - y;
+		}
+	}
+
+	// Bodies without gravity or without acceleration are outside the integrable group. They are few, so they take the separate steps one body at a time (the two views do not overlap)
+
+	void integrateRemaining(entt::registry& registry)
+	{
+		auto weightless{ registry.view<VelocityComponent, MoveComponent, SpatialComponent>(entt::exclude<GravityComponent>) };
+
+		for (auto [entity, velocity, move, spatial] : weightless.each()) {
+			if (const auto* acceleration{ registry.try_get<AccelerationComponent>(entity) }) {
+				velocity.x += acceleration->x;
+				velocity.y += acceleration->y;
+
+				if (velocity.x > 16) {
+					velocity.x = 16;
+				}
+				if (velocity.y > 16) {
+					velocity.y = 16;
+				}
+			}
+
+			accumulate(velocity, move);
+		}
+
+		auto unaccelerated{ registry.view<VelocityComponent, MoveComponent, SpatialComponent, GravityComponent>(entt::exclude<AccelerationComponent>) };
+
+		for (auto [entity, velocity, move, spatial, gravity] : unaccelerated.each()) {
+			velocity.y += gravity.g;
+
+			accumulate(velocity, move);
+		}
+	}
+
+	// The owned pools keep the members of the group packed at their front, in the same order, so the group is walked as plain arrays a page at a time rather than entity by entity
+
+	void integrate(entt::registry& registry)
+	{
+		constexpr std::size_t pagesize{ entt::component_traits<VelocityComponent>::page_size };
+		static_assert(entt::component_traits<MoveComponent>::page_size == pagesize && entt::component_traits<GravityComponent>::page_size == pagesize && entt::component_traits<AccelerationComponent>::page_size == pagesize, "integrate walks the pools page by page in lockstep");
+
+		std::size_t count{ integrables(registry).size() };
+		auto& velocities{ registry.storage<VelocityComponent>() };
+		auto& moves{ registry.storage<MoveComponent>() };
+		const auto& gravities{ registry.storage<GravityComponent>() };
+		const auto& accelerations{ registry.storage<AccelerationComponent>() };
+
+		for (std::size_t first{ 0 }; first < count; first += pagesize) {
+			std::size_t page{ first / pagesize };
+			integrateSpan(velocities.raw()[page], moves.raw()[page], gravities.raw()[page], accelerations.raw()[page], std::min(pagesize, count - first));
+		}
+
+		integrateRemaining(registry);
+	}
+
+	void updatePosition(entt::registry& registry, const Config& config)
+	{
+		auto view2{ registry.view<SpatialComponent>() };
+
+		for (auto [entity1, velocity1, move1, spatial1] : bodies(registry).each()) {
+			SpatialComponent start{ spatial1 };
+
+			// Move along the Y-axis one pixel at a time and test for collisions every step, only moving if there is nothing ahead
+			{
+				int sign{ (move1.y > 0) - (move1.y < 0) }; // Computes the sign (or false if still) of the Y-vector. Either 1 (downwards), 0 (still) or -1 (upwards)
+				bool stop{ false };
+
+				while (move1.y) {
+					for (auto [entity2, spatial2] : view2.each()) {
+						if (entity2 != entity1) {
+							if (collideAt(spatial1, spatial2, Vector2D{ 0, sign })) {
+								stop = true;
+							}
+						}
+					}
+
+					if (!stop) {
+						spatial1.y += sign;
+						move1.y -= sign;
+					}
+					else {
+						break;
+					}
+				}
+			}
+
+			// Move along the X-axis one pixel at a time and test for collisions every step, only moving if there is nothing ahead
+			{
+				int sign{ (move1.x > 0) - (move1.x < 0) }; // Computes the sign (or false if still) of the X-vector. Either 1 (right), 0 (still) or -1 (left)
+				bool stop{ false };
+
+				while (move1.x) {
+					for (auto [entity2, spatial2] : view2.each()) {
+						if (entity2 != entity1) {
+							if (collideAt(spatial1, spatial2, Vector2D{ sign, 0 })) {
+								stop = true;
+							}
+						}
+					}
+
+					if (!stop) {
+						spatial1.x += sign;
+						move1.x -= sign;
+					}
+					else {
+						break;
+					}
+				}
+			}
+
+			// Window Bounds. Make sure nothing can move outside the window frame
+			int worldpixelwidth{ config.tilesize * config.worldscale * config.worldwidth };
+			int worldpixelheight{ config.tilesize * config.worldscale * config.worldheight };
+
+			if (spatial1.x < 0) spatial1.x = 0;
+			if (spatial1.y < 0) spatial1.y = 0;
+			if (spatial1.x + spatial1.w > worldpixelwidth) spatial1.x = worldpixelwidth - spatial1.w;
+			if (spatial1.y + spatial1.h > worldpixelheight) spatial1.y = worldpixelheight - spatial1.h;
+
+			if (spatial1.x != start.x || spatial1.y != start.y) {
+				registry.emplace_or_replace<MovedComponent>(entity1);
+			}
+		}
+	}
+}
+
+// Contains the trigger volumes. Triggers are kept in a uniform grid (one cell per tile) so each mover only tests the triggers in the cells it covers, and overlaps are turned into events that are queued on a dispatcher and handled once detection is done
+
+namespace Triggers {
+	struct Enter
+	{
+		entt::entity trigger;
+		entt::entity mover;
+	};
+
+	struct Stay
+	{
+		entt::entity trigger;
+		entt::entity mover;
+	};
+
+	struct Exit
+	{
+		entt::entity trigger;
+		entt::entity mover;
+	};
+
+	// The broadphase. It follows TriggerComponent through the registry's signals, so triggers are indexed as they are emplaced, replaced or destroyed
+
+	class Index
+	{
+	public:
+		Index() = default;
+		Index(const Index&) = delete;
+		Index& operator=(const Index&) = delete;
+
+		~Index()
+		{
+			if (registry) {
+				registry->on_construct<TriggerComponent>().disconnect<&Index::onConstruct>(*this);
+				registry->on_update<TriggerComponent>().disconnect<&Index::onUpdate>(*this);
+				registry->on_destroy<TriggerComponent>().disconnect<&Index::onDestroy>(*this);
+			}
+		}
+
+		void connect(entt::registry& target)
+		{
+			registry = &target;
+			registry->on_construct<TriggerComponent>().connect<&Index::onConstruct>(*this);
+			registry->on_update<TriggerComponent>().connect<&Index::onUpdate>(*this);
+			registry->on_destroy<TriggerComponent>().connect<&Index::onDestroy>(*this);
+		}
+
+		// Resizes the grid and indexes every existing trigger again. Only cells holding a trigger are stored, so the cost follows the triggers rather than the size of the level
+
+		void reset(int size, int columncount, int rowcount)
+		{
+			cellsize = std::max(1, size);
+			columns = columncount;
+			rows = rowcount;
+
+			cells.clear();
+			placed.clear();
+
+			if (registry) {
+				auto view{ registry->view<TriggerComponent>() };
+
+				for (auto [entity, trigger] : view.each()) {
+					insert(entity, trigger);
+				}
+			}
+		}
+
+		// Calls the function for every trigger sharing a cell with the area. A trigger spanning several cells may be reported more than once
+
+		template <typename Function>
+		void query(const SpatialComponent& area, Function&& function) const
+		{
+			SDL_Rect range{ cellRange(area.x, area.y, area.w, area.h) };
+
+			for (int row{ range.y }; row <= range.h; ++row) {
+				for (int col{ range.x }; col <= range.w; ++col) {
+					auto cell{ cells.find(static_cast<std::size_t>(row) * columns + col) };
+					if (cell == cells.end()) {
+						continue;
+					}
+
+					for (auto trigger : cell->second) {
+						function(trigger);
+					}
+				}
+			}
+		}
+
+	private:
+		void onConstruct(entt::registry& target, entt::entity entity)
+		{
+			insert(entity, target.get<TriggerComponent>(entity));
+		}
+
+		void onUpdate(entt::registry& target, entt::entity entity)
+		{
+			erase(entity);
+			insert(entity, target.get<TriggerComponent>(entity));
+		}
+
+		void onDestroy(entt::registry&, entt::entity entity)
+		{
+			erase(entity);
+		}
+
+		// First column and row in x and y, last column and row (inclusive) in w and h. Empty (x > w) when there is no grid
+
+		SDL_Rect cellRange(int x, int y, int w, int h) const
+		{
+			if (columns <= 0 || rows <= 0) {
+				return SDL_Rect{ 0, 0, -1, -1 };
+			}
+
+			return SDL_Rect{
+				std::clamp(x / cellsize, 0, columns - 1),
+				std::clamp(y / cellsize, 0, rows - 1),
+				std::clamp((x + w - 1) / cellsize, 0, columns - 1),
+				std::clamp((y + h - 1) / cellsize, 0, rows - 1)
+			};
+		}
+
+		void insert(entt::entity entity, const TriggerComponent& trigger)
+		{
+			SDL_Rect range{ cellRange(trigger.x, trigger.y, trigger.w, trigger.h) };
+
+			for (int row{ range.y }; row <= range.h; ++row) {
+				for (int col{ range.x }; col <= range.w; ++col) {
+					cells[static_cast<std::size_t>(row) * columns + col].push_back(entity);
+				}
+			}
+
+			placed[entity] = range;
+		}
+
+		void erase(entt::entity entity)
+		{
+			auto found{ placed.find(entity) };
+			if (found == placed.end()) {
+				return;
+			}
+
+			const SDL_Rect& range{ found->second };
+
+			for (int row{ range.y }; row <= range.h; ++row) {
+				for (int col{ range.x }; col <= range.w; ++col) {
+					auto cell{ cells.find(static_cast<std::size_t>(row) * columns + col) };
+					if (cell == cells.end()) {
+						continue;
+					}
+
+					auto& triggers{ cell->second };
+					auto position{ std::find(triggers.begin(), triggers.end(), entity) };
+
+					if (position != triggers.end()) {
+						*position = triggers.back();
+						triggers.pop_back();
+					}
+
+					if (triggers.empty()) {
+						cells.erase(cell);
+					}
+				}
+			}
+
+			placed.erase(found);
+		}
+
+		entt::registry* registry{ nullptr };
+		int cellsize{ 1 };
+		int columns{ 0 };
+		int rows{ 0 };
+		std::unordered_map<std::size_t, std::vector<entt::entity>> cells{}; // Keyed by row * columns + col, empty cells are left out
+		std::unordered_map<entt::entity, SDL_Rect> placed{}; // The cells each trigger was inserted into
+	};
+
+	// Remembers which (trigger, mover) pairs overlapped last tick so enter, stay and exit can be told apart
+
+	class Tracker
+	{
+	public:
+		// Only queues events, nothing is dispatched here. Handlers run on dispatcher.update(), after every view used for detection is done iterating
+
+		void detect(entt::registry& registry, const Index& index, entt::dispatcher& dispatcher)
+		{
+			current.clear();
+
+			for (auto [mover, velocity, move, spatial] : Physics::bodies(registry).each()) {
+				index.query(spatial, [&](entt::entity trigger) {
+					const auto& volume{ registry.get<TriggerComponent>(trigger) };
+
+					if (trigger != mover && collideAt(spatial, SpatialComponent{ volume.x, volume.y, volume.w, volume.h })) {
+						current.emplace_back(trigger, mover);
+					}
+				});
+			}
+
+			std::sort(current.begin(), current.end());
+			current.erase(std::unique(current.begin(), current.end()), current.end());
+
+			// Both lists are sorted, so one merge finds what was entered, stayed in and exited
+
+			auto previousPair{ previous.begin() };
+			auto currentPair{ current.begin() };
+
+			while (previousPair != previous.end() || currentPair != current.end()) {
+				if (currentPair == current.end() || (previousPair != previous.end() && *previousPair < *currentPair)) {
+					if (registry.valid(previousPair->first) && registry.valid(previousPair->second)) {
+						dispatcher.enqueue<Exit>(previousPair->first, previousPair->second);
+					}
+					++previousPair;
+				}
+				else if (previousPair == previous.end() || *currentPair < *previousPair) {
+					dispatcher.enqueue<Enter>(currentPair->first, currentPair->second);
+					++currentPair;
+				}
+				else {
+					dispatcher.enqueue<Stay>(currentPair->first, currentPair->second);
+					++previousPair;
+					++currentPair;
+				}
+			}
+
+			std::swap(previous, current);
+		}
+
+	private:
+		std::vector<std::pair<entt::entity, entt::entity>> previous{};
+		std::vector<std::pair<entt::entity, entt::entity>> current{};
+	};
+}
+
+// Gives a coin to whatever accumulator enters a collectable trigger and moves only that coin somewhere else
+
+struct CoinCollector
+{
+	entt::registry& registry;
+	const Config& config;
+
+	void onEnter(const Triggers::Enter& event)
+	{
+		if (!registry.valid(event.trigger) || !registry.valid(event.mover) || !registry.all_of<CollectableComponent>(event.trigger)) {
+			return;
+		}
+
+		auto* accumulator{ registry.try_get<AccumulatorComponent>(event.mover) };
+
+		if (accumulator) {
+			std::cout << "Coins: " << ++accumulator->coins << '\n';
+			Random::randomizeCoinLocation(registry, event.trigger, config.worldwidth, config.worldheight, config.worldscale * config.tilesize);
+		}
+	}
+};
+
+// Contains per-entity behaviors written as C++20 coroutines. A behavior suspends on awaitables like waitTicks(n) or untilGrounded() and a scheduler resumes every behavior that is due once per tick. Coroutine frames come from a pool, so spawning behaviors does not hit the heap once the pool has warmed up
+
+namespace Script {
+	// Free lists of frames in 64 byte size classes. Frames larger than the biggest class fall back to the heap. Not thread safe, behaviors only run on the main thread
+
+	class FramePool
+	{
+	public:
+		FramePool() = default;
+		FramePool(const FramePool&) = delete;
+		FramePool& operator=(const FramePool&) = delete;
+
+		void* allocate(std::size_t size)
+		{
+			std::size_t sizeclass{ (size + granularity - 1) / granularity };
+
+			if (sizeclass >= freelists.size()) {
+				return ::operator new(size);
+			}
+
+			auto& freelist{ freelists[sizeclass] };
+
+			if (freelist.empty()) {
+				// Grow by a whole chunk of frames of this class at once
+				std::size_t blocksize{ sizeclass * granularity };
+				chunks.push_back(std::make_unique<std::byte[]>(blocksize * blocksperchunk));
+
+				for (std::size_t block{ 0 }; block < blocksperchunk; ++block) {
+					freelist.push_back(chunks.back().get() + block * blocksize);
+				}
+			}
+
+			void* frame{ freelist.back() };
+			freelist.pop_back();
+			return frame;
+		}
+
+		void deallocate(void* frame, std::size_t size)
+		{
+			std::size_t sizeclass{ (size + granularity - 1) / granularity };
+
+			if (sizeclass >= freelists.size()) {
+				::operator delete(frame);
+				return;
+			}
+
+			freelists[sizeclass].push_back(frame);
+		}
+
+	private:
+		static constexpr std::size_t granularity{ 64 };
+		static constexpr std::size_t blocksperchunk{ 256 };
+
+		std::array<std::vector<void*>, 17> freelists{}; // Classes of up to 1024 bytes
+		std::vector<std::unique_ptr<std::byte[]>> chunks{};
+	};
+
+	FramePool framepool{};
+
+	class Scheduler;
+
+	// The coroutine type of a behavior. It owns its frame until it is handed to a scheduler
+
+	class Behavior
+	{
+	public:
+		struct promise_type
+		{
+			Scheduler* scheduler{ nullptr };
+			entt::entity entity{ entt::null };
+
+			Behavior get_return_object()
+			{
+				return Behavior{ std::coroutine_handle<promise_type>::from_promise(*this) };
+			}
+
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			std::suspend_always final_suspend() noexcept
+			{
+				return {};
+			}
+
+			void return_void()
+			{
+			}
+
+			void unhandled_exception()
+			{
+				throw;
+			}
+
+			static void* operator new(std::size_t size)
+			{
+				return framepool.allocate(size);
+			}
+
+			static void operator delete(void* frame, std::size_t size)
+			{
+				framepool.deallocate(frame, size);
+			}
+		};
+
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Behavior(Behavior&& other) noexcept : handle{ std::exchange(other.handle, nullptr) }
+		{
+		}
+
+		Behavior& operator=(Behavior&& other) noexcept
+		{
+			if (this != &other) {
+				if (handle) {
+					handle.destroy();
+				}
+				handle = std::exchange(other.handle, nullptr);
+			}
+			return *this;
+		}
+
+		~Behavior()
+		{
+			if (handle) {
+				handle.destroy();
+			}
+		}
+
+		Handle release()
+		{
+			return std::exchange(handle, nullptr);
+		}
+
+	private:
+		explicit Behavior(Handle handle) : handle{ handle }
+		{
+		}
+
+		Handle handle;
+	};
+
+	// Resumes behaviors in batches once per tick. Sleeping behaviors sit in a heap ordered by the tick they wake on, so a tick only touches the ones that are due, plus the ones waiting on a condition
+
+	class Scheduler
+	{
+	public:
+		explicit Scheduler(entt::registry& registry) : registry{ registry }
+		{
+		}
+
+		Scheduler(const Scheduler&) = delete;
+		Scheduler& operator=(const Scheduler&) = delete;
+
+		~Scheduler()
+		{
+			for (auto& sleeper : sleepers) {
+				sleeper.handle.destroy();
+			}
+			for (auto handle : grounded) {
+				handle.destroy();
+			}
+		}
+
+		// Starts a behavior right away. It runs until its first suspension and is destroyed together with its entity
+
+		void spawn(Behavior behavior, entt::entity entity = entt::null)
+		{
+			auto handle{ behavior.release() };
+			handle.promise().scheduler = this;
+			handle.promise().entity = entity;
+			resume(handle);
+		}
+
+		void tick()
+		{
+			++now;
+			batch.clear();
+
+			while (!sleepers.empty() && sleepers.front().wake <= now) {
+				std::pop_heap(sleepers.begin(), sleepers.end(), later);
+				batch.push_back(sleepers.back().handle);
+				sleepers.pop_back();
+			}
+
+			auto waiting{ std::partition(grounded.begin(), grounded.end(), [&](Behavior::Handle handle) {
+				auto entity{ handle.promise().entity };
+				const auto* jump{ registry.valid(entity) ? registry.try_get<JumpComponent>(entity) : nullptr };
+				return jump && !jump->canJump;
+			}) };
+
+			batch.insert(batch.end(), waiting, grounded.end());
+			grounded.erase(waiting, grounded.end());
+
+			// Behaviors suspending again while the batch runs go back into the heap or the grounded list, never into the batch
+
+			for (auto handle : batch) {
+				resume(handle);
+			}
+		}
+
+		std::size_t size() const
+		{
+			return sleepers.size() + grounded.size();
+		}
+
+		void sleep(Behavior::Handle handle, int ticks)
+		{
+			sleepers.push_back(Sleeper{ now + static_cast<std::uint64_t>(ticks), handle });
+			std::push_heap(sleepers.begin(), sleepers.end(), later);
+		}
+
+		void waitGrounded(Behavior::Handle handle)
+		{
+			grounded.push_back(handle);
+		}
+
+	private:
+		struct Sleeper
+		{
+			std::uint64_t wake;
+			Behavior::Handle handle;
+		};
+
+		static bool later(const Sleeper& first, const Sleeper& second)
+		{
+			return first.wake > second.wake;
+		}
+
+		void resume(Behavior::Handle handle)
+		{
+			auto entity{ handle.promise().entity };
+
+			if (entity != entt::null && !registry.valid(entity)) {
+				handle.destroy();
+				return;
+			}
+
+			handle.resume();
+
+			if (handle.done()) {
+				handle.destroy();
+			}
+		}
+
+		entt::registry& registry;
+		std::uint64_t now{ 0 };
+		std::vector<Sleeper> sleepers{};
+		std::vector<Behavior::Handle> grounded{};
+		std::vector<Behavior::Handle> batch{}; // Reused every tick
+	};
+
+	// Suspends the behavior for the given number of ticks
+
+	struct WaitTicks
+	{
+		int ticks;
+
+		bool await_ready() const noexcept
+		{
+			return ticks <= 0;
+		}
+
+		void await_suspend(Behavior::Handle handle) const
+		{
+			handle.promise().scheduler->sleep(handle, ticks);
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+	// Suspends the behavior until its entity can jump
+
+	struct UntilGrounded
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(Behavior::Handle handle) const
+		{
+			handle.promise().scheduler->waitGrounded(handle);
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+	WaitTicks waitTicks(int ticks)
+	{
+		return WaitTicks{ ticks };
+	}
+
+	UntilGrounded untilGrounded()
+	{
+		return UntilGrounded{};
+	}
+}
+
+// Ends the game once the player has collected enough coins (also prints the time since the program started)
+
+Script::Behavior winCondition(entt::registry& registry, entt::entity player, int coinsToWin, bool& isRunning)
+{
+	while (registry.get<AccumulatorComponent>(player).coins < coinsToWin) {
+		co_await Script::waitTicks(1);
+	}
+
+	std::cout << "Time: " << SDL_GetTicks64() / 1000.0 << '\n';
+	isRunning = false;
+}
+
+// Memory accounting. Every allocation through the global operator new is counted, and a report lists the live entities and, for each component pool, how many components it holds and the bytes it has reserved
+
+namespace Memory {
+	inline std::atomic<std::size_t> allocations{ 0 };
+	inline std::atomic<std::size_t> allocatedbytes{ 0 };
+
+	struct Counts
+	{
+		std::size_t allocations;
+		std::size_t bytes;
+
+		Counts operator-(const Counts& other) const
+		{
+			return Counts{ allocations - other.allocations, bytes - other.bytes };
+		}
+	};
+
+	Counts counts()
+	{
+		return Counts{ allocations.load(std::memory_order_relaxed), allocatedbytes.load(std::memory_order_relaxed) };
+	}
+
+	struct Pool
+	{
+		std::string_view name;
+		std::size_t size; // Components in use
+		std::size_t capacity; // Components room is reserved for
+		std::size_t packedbytes; // The packed entity array and the components themselves
+		std::size_t sparsebytes; // The sparse array, which grows with the highest entity id rather than with size
+
+		std::size_t bytes() const
+		{
+			return packedbytes + sparsebytes;
+		}
+	};
+
+	struct Report
+	{
+		std::size_t entities;
+		Counts frame; // Allocations during the last frame
+		std::vector<Pool> pools;
+
+		std::size_t bytes() const
+		{
+			std::size_t total{ 0 };
+			for (const auto& pool : pools) {
+				total += pool.bytes();
+			}
+			return total;
+		}
+	};
+
+	template <typename Component>
+	Pool pool(entt::registry& registry, std::string_view name)
+	{
+		auto& storage{ registry.storage<Component>() };
+
+		Pool pool{ name, storage.size(), storage.capacity(), storage.capacity() * sizeof(entt::entity), storage.extent() * sizeof(entt::entity) };
+
+		// Empty components are not stored at all, only their entities are
+
+		if constexpr (!std::is_empty_v<Component>) {
+			pool.packedbytes += storage.capacity() * sizeof(Component);
+		}
+
+		return pool;
+	}
+
+	// Keeps the report of one registry. Refreshing it only reads the pool sizes and never walks a pool
+
+	class Accounting
+	{
+	public:
+		Accounting(entt::registry& registry) : registry{ registry }
+		{
+		}
+
+		// Refreshes the report in place. The pool list keeps its buffer, so only the first refresh allocates
+
+		const Report& refresh(Counts frame)
+		{
+			current.entities = registry.alive();
+			current.frame = frame;
+			current.pools.clear();
+
+			current.pools.push_back(pool<VisualComponent>(registry, "visual"));
+			current.pools.push_back(pool<SpatialComponent>(registry, "spatial"));
+			current.pools.push_back(pool<VelocityComponent>(registry, "velocity"));
+			current.pools.push_back(pool<AccelerationComponent>(registry, "acceleration"));
+			current.pools.push_back(pool<GravityComponent>(registry, "gravity"));
+			current.pools.push_back(pool<MoveComponent>(registry, "move"));
+			current.pools.push_back(pool<JumpComponent>(registry, "jump"));
+			current.pools.push_back(pool<RunComponent>(registry, "run"));
+			current.pools.push_back(pool<CollectableComponent>(registry, "collectable"));
+			current.pools.push_back(pool<AccumulatorComponent>(registry, "accumulator"));
+			current.pools.push_back(pool<DebugComponent>(registry, "debug"));
+			current.pools.push_back(pool<TileComponent>(registry, "tile"));
+			current.pools.push_back(pool<SpriteComponent>(registry, "sprite"));
+			current.pools.push_back(pool<TriggerComponent>(registry, "trigger"));
+			current.pools.push_back(pool<ChaseComponent>(registry, "chase"));
+			current.pools.push_back(pool<MovedComponent>(registry, "moved"));
+			current.pools.push_back(pool<CameraComponent>(registry, "camera"));
+			current.pools.push_back(pool<AnimatorComponent>(registry, "animator"));
+
+			return current;
+		}
+
+		const Report& report() const
+		{
+			return current;
+		}
+
+	private:
+		entt::registry& registry;
+		Report current{};
+	};
+
+	void writeJson(std::ostream& out, const Report& report)
+	{
+		out << "{\n"
+			<< "\t\"entities\": " << report.entities << ",\n"
+			<< "\t\"bytes\": " << report.bytes() << ",\n"
+			<< "\t\"frame\": { \"allocations\": " << report.frame.allocations << ", \"bytes\": " << report.frame.bytes << " },\n"
+			<< "\t\"pools\": [\n";
+
+		for (std::size_t i{ 0 }; i < report.pools.size(); ++i) {
+			const auto& pool{ report.pools[i] };
+
+			out << "\t\t{ \"name\": \"" << pool.name << "\", \"size\": " << pool.size << ", \"capacity\": " << pool.capacity
+				<< ", \"packedbytes\": " << pool.packedbytes << ", \"sparsebytes\": " << pool.sparsebytes << " }"
+				<< (i + 1 < report.pools.size() ? ",\n" : "\n");
+		}
+
+		out << "\t]\n"
+			<< "}\n";
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	Memory::allocations.fetch_add(1, std::memory_order_relaxed);
+	Memory::allocatedbytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (void* pointer{ std::malloc(size ? size : 1) }) {
+		return pointer;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+// Times every frame and the systems in it. When a frame runs over its budget an incident is written with the time of each system, the entity counts and the recent frame times. The incident file is a ring of fixed-size slots shared by every run, so it never grows past its slot count and the oldest incident is overwritten first
+
+class FrameWatchdog
+{
+public:
+	// Adds the time from its creation to its destruction to the frame as one system
+
+	class Timer
+	{
+	public:
+		Timer(FrameWatchdog& watchdog, std::string_view system) : watchdog{ watchdog }, system{ system }, start{ std::chrono::steady_clock::now() }
+		{
+		}
+
+		Timer(const Timer&) = delete;
+		Timer& operator=(const Timer&) = delete;
+
+		~Timer()
+		{
+			std::chrono::duration<double, std::milli> elapsed{ std::chrono::steady_clock::now() - start };
+			watchdog.systems.emplace_back(system, elapsed.count());
+		}
+
+	private:
+		FrameWatchdog& watchdog;
+		std::string_view system;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	FrameWatchdog(const std::string& incidentfile, int slotcount) : incidentfile{ incidentfile }, slotcount{ std::max(1, slotcount) }
+	{
+		systems.reserve(32);
+	}
+
+	void beginFrame()
+	{
+		systems.clear();
+		start = std::chrono::steady_clock::now();
+	}
+
+	Timer measure(std::string_view system)
+	{
+		return Timer{ *this, system };
+	}
+
+	// Ends the frame and writes an incident if it ran over the budget. The counts are only gathered then, by calling writeCounts with the stream to write them to
+
+	template <typename Function>
+	void endFrame(double budget, Function&& writeCounts)
+	{
+		std::chrono::duration<double, std::milli> elapsed{ std::chrono::steady_clock::now() - start };
+
+		frametimes[frame % frametimes.size()] = elapsed.count();
+		++frame;
+
+		if (elapsed.count() > budget && open()) {
+			std::ostringstream incident{};
+			writeIncident(incident, elapsed.count(), budget);
+
+			incident << "entities:\n";
+			writeCounts(incident);
+
+			writeSlot(incident.str());
+		}
+	}
+
+private:
+	static constexpr std::size_t slotsize{ 4096 };
+
+	void writeIncident(std::ostream& out, double elapsed, double budget) const
+	{
+		// Every measured system gets an equal share of the budget
+
+		double share{ budget / std::max<std::size_t>(1, systems.size()) };
+
+		std::time_t now{ std::time(nullptr) };
+
+		out << "incident " << incidents << " at " << std::put_time(std::gmtime(&now), "%Y-%m-%dT%H:%M:%SZ") << ", frame " << frame - 1 << '\n'
+			<< "frame\t" << elapsed << " ms (budget " << budget << " ms, share " << share << " ms per system)\n"
+			<< "systems:\n";
+
+		for (const auto& [system, time] : systems) {
+			out << '\t' << system << '\t' << time << " ms" << (time > share ? "\tOVER" : "") << '\n';
+		}
+
+		out << "recent frames (ms, oldest first):\n\t";
+
+		std::size_t count{ std::min<std::size_t>(frame, frametimes.size()) };
+		for (std::size_t i{ frame - count }; i < frame; ++i) {
+			out << frametimes[i % frametimes.size()] << ' ';
+		}
+
+		out << '\n';
+	}
+
+	// Opens the incident file on the first incident of a run. Incidents of earlier runs are kept, the sequence carries on after the newest one found in the slots
+
+	bool open()
+	{
+		if (file.is_open()) {
+			return true;
+		}
+
+		file.open(incidentfile, std::ios::in | std::ios::out | std::ios::binary);
+
+		if (!file.is_open()) {
+			std::ofstream{ incidentfile, std::ios::binary };
+			file.open(incidentfile, std::ios::in | std::ios::out | std::ios::binary);
+		}
+
+		if (!file.is_open()) {
+			std::cerr << "File failed to open...('" << incidentfile << "')\n";
+			return false;
+		}
+
+		std::cout << "File opened...('" << incidentfile << "')\n";
+
+		// Every slot starts with 'incident <sequence> at ...', empty or unreadable slots are skipped
+
+		for (int slot{ 0 }; slot < slotcount; ++slot) {
+			file.clear();
+			file.seekg(static_cast<std::streamoff>(slot * slotsize));
+
+			std::string word{};
+			std::size_t sequence{ 0 };
+
+			if (file >> word >> sequence && word == "incident") {
+				incidents = std::max(incidents, sequence + 1);
+			}
+		}
+
+		file.clear();
+		return true;
+	}
+
+	void writeSlot(std::string incident)
+	{
+		// Slots are padded to a fixed size so each incident can be overwritten in place
+
+		incident.resize(slotsize - 1, ' ');
+		incident.push_back('\n');
+
+		file.seekp(static_cast<std::streamoff>((incidents % slotcount) * slotsize));
+		file.write(incident.data(), static_cast<std::streamsize>(incident.size()));
+		file.flush();
+
+		std::cout << "Frame over budget, incident " << incidents << " written...('" << incidentfile << "')\n";
+		++incidents;
+	}
+
+	std::string incidentfile;
+	int slotcount;
+	std::fstream file{};
+	std::size_t incidents{ 0 }; // Sequence number of the next incident, continued across runs
+	std::size_t frame{ 0 };
+	std::chrono::steady_clock::time_point start{};
+	std::vector<std::pair<std::string_view, double>> systems{};
+	std::array<double, 120> frametimes{};
+};
+
+// Headless benchmarks, run with '--bench <name>'. Each one prints a table of per-entity costs and never touches SDL
+
+namespace Benchmark {
+	using Clock = std::chrono::steady_clock;
+
+	// The integration passes as they were before movers were grouped (a view per pass and a sparse lookup per component), kept as the baseline to measure against
+
+	void integrateUngrouped(entt::registry& registry)
+	{
+		auto gravityview{ registry.view<VelocityComponent, GravityComponent>() };
+
+		for (auto entity : gravityview) {
+			auto& velocity{ registry.get<VelocityComponent>(entity) };
+			const auto& gravity{ registry.get<GravityComponent>(entity) };
+
+			velocity.y += gravity.g;
+		}
+
+		auto accelerationview{ registry.view<VelocityComponent, AccelerationComponent>() };
+
+		for (auto entity : accelerationview) {
+			auto& velocity{ registry.get<VelocityComponent>(entity) };
+			const auto& acceleration{ registry.get<AccelerationComponent>(entity) };
+
+			velocity.x += acceleration.x;
+			velocity.y += acceleration.y;
+
+			if (velocity.x > 16) {
+				velocity.x = 16;
+			}
+			if (velocity.y > 16) {
+				velocity.y = 16;
+			}
+		}
+
+		auto moveview{ registry.view<VelocityComponent, MoveComponent>() };
+
+		for (auto entity : moveview) {
+			auto& move{ registry.get<MoveComponent>(entity) };
+			const auto& velocity{ registry.get<VelocityComponent>(entity) };
+
+			move.xr += velocity.x;
+			move.yr += velocity.y;
+
+			move.x = static_cast<int>(std::round(move.xr));
+			move.y = static_cast<int>(std::round(move.yr));
+
+			move.xr -= move.x;
+			move.yr -= move.y;
+		}
+	}
+
+	// The fused integrator as it was before it walked the pools as arrays (one entity at a time through the group), kept as the baseline to measure against
+
+	void integrateEach(entt::registry& registry)
+	{
+		for (auto [entity, velocity, move, spatial, gravity, acceleration] : Physics::integrables(registry).each()) {
+			float vx{ velocity.x + acceleration.x };
+			float vy{ (velocity.y + gravity.g) + acceleration.y };
+
+			vx = std::min(vx, 16.0f);
+			vy = std::min(vy, 16.0f);
+
+			velocity.x = vx;
+			velocity.y = vy;
+
+			float xr{ move.xr + vx };
+			float yr{ move.yr + vy };
+			float x{ std::round(xr) };
+			float y{ std::round(yr) };
+
+			move.x = static_cast<int>(x);
+			move.y = static_cast<int>(y);
+			move.xr = xr - x;
+			move.yr = yr - y;
+		}
+
+		Physics::integrateRemaining(registry);
+	}
+
+	// Fills a registry with movers the way the player is set up. Every other entity is a static tile so the pools interleave like in a real level
+
+	void populate(entt::registry& registry, int movers)
+	{
+		for (int i{ 0 }; i < movers; ++i) {
+			auto tile{ registry.create() };
+			registry.emplace<SpatialComponent>(tile, i * 8, 0, 8, 8);
+
+			auto mover{ registry.create() };
+			registry.emplace<SpatialComponent>(mover, i * 8, 8, 4, 8);
+			registry.emplace<VelocityComponent>(mover, static_cast<float>(Random::get(-4, 4)), 0.0f);
+			registry.emplace<AccelerationComponent>(mover);
+			registry.emplace<GravityComponent>(mover, 0.5f);
+			registry.emplace<MoveComponent>(mover);
+		}
+	}
+
+	// Adds bodies missing gravity, acceleration or both, which the fused integrator has to handle outside its group
+
+	void populatePartial(entt::registry& registry, int bodies)
+	{
+		for (int i{ 0 }; i < bodies; ++i) {
+			auto body{ registry.create() };
+			registry.emplace<SpatialComponent>(body, i * 8, 16, 4, 8);
+			registry.emplace<VelocityComponent>(body, static_cast<float>(Random::get(-4, 4)), 0.0f);
+			registry.emplace<MoveComponent>(body);
+
+			if (i % 3 != 0) {
+				registry.emplace<AccelerationComponent>(body, 0.25f, 0.0f);
+			}
+			if (i % 3 != 1) {
+				registry.emplace<GravityComponent>(body, 0.5f);
+			}
+		}
+	}
+
+	template <typename Function>
+	double nanosecondsPerEntity(Function&& function, int movers, int ticks)
+	{
+		auto start{ Clock::now() };
+
+		for (int tick{ 0 }; tick < ticks; ++tick) {
+			function();
+		}
+
+		std::chrono::duration<double, std::nano> elapsed{ Clock::now() - start };
+
+		return elapsed.count() / (static_cast<double>(movers) * ticks);
+	}
+
+	void physics()
+	{
+		std::cout << "movers\t\tungrouped (ns/entity)\tgrouped (ns/entity)\n";
+
+		for (int movers : { 1000, 10000, 100000, 1000000 }) {
+			int ticks{ std::max(10, 10000000 / movers) };
+
+			entt::registry ungrouped{};
+			populate(ungrouped, movers);
+
+			entt::registry grouped{};
+			Physics::bodies(grouped);
+			populate(grouped, movers);
+
+			double before{ nanosecondsPerEntity([&]() { integrateUngrouped(ungrouped); }, movers, ticks) };
+			double after{ nanosecondsPerEntity([&]() {
+				Physics::applyGravity(grouped);
+				Physics::applyAcceleration(grouped);
+				Physics::applyVelocity(grouped);
+			}, movers, ticks) };
+
+			std::cout << movers << "\t\t" << before << "\t\t\t" << after << '\n';
+		}
+	}
+
+	// Runs the separate systems, the fused integrator one entity at a time and the fused integrator over plain arrays on identical registries (including some bodies outside the fused group), checks that every mover ends up in the same state and compares their speed
+
+	void integrator()
+	{
+		std::cout << "movers\t\tseparate (ns/entity)\tper entity (ns/entity)\tarrays (ns/entity)\tidentical\n";
+
+		for (int movers : { 1000, 10000, 100000, 1000000 }) {
+			int ticks{ std::max(10, 10000000 / movers) };
+
+			entt::registry separate{};
+			Physics::bodies(separate);
+			Physics::integrables(separate);
+			Random::mt.seed(movers);
+			populate(separate, movers);
+			populatePartial(separate, movers / 16);
+
+			entt::registry each{};
+			Physics::bodies(each);
+			Physics::integrables(each);
+			Random::mt.seed(movers);
+			populate(each, movers);
+			populatePartial(each, movers / 16);
+
+			entt::registry fused{};
+			Physics::bodies(fused);
+			Physics::integrables(fused);
+			Random::mt.seed(movers);
+			populate(fused, movers);
+			populatePartial(fused, movers / 16);
+
+			double before{ nanosecondsPerEntity([&]() {
+				Physics::applyGravity(separate);
+				Physics::applyAcceleration(separate);
+				Physics::applyVelocity(separate);
+			}, movers, ticks) };
+			double between{ nanosecondsPerEntity([&]() { integrateEach(each); }, movers, ticks) };
+			double after{ nanosecondsPerEntity([&]() { Physics::integrate(fused); }, movers, ticks) };
+
+			// Entities are created in the same order in all registries, so the same identifiers refer to the same movers
+
+			bool isIdentical{ true };
+			for (auto [entity, velocity, move, spatial] : Physics::bodies(separate).each()) {
+				for (const entt::registry* other : { &each, &fused }) {
+					const auto& otherVelocity{ other->get<VelocityComponent>(entity) };
+					const auto& otherMove{ other->get<MoveComponent>(entity) };
+
+					if (velocity.x != otherVelocity.x || velocity.y != otherVelocity.y || move.x != otherMove.x || move.y != otherMove.y || move.xr != otherMove.xr || move.yr != otherMove.yr) {
+						isIdentical = false;
+					}
+				}
+
+				if (!isIdentical) {
+					break;
+				}
+			}
+
+			std::cout << movers << "\t\t" << before << "\t\t\t" << between << "\t\t\t" << after << "\t\t\t" << std::boolalpha << isIdentical << '\n';
+		}
+	}
+
+	// Peak resident set size of the process so far, in kilobytes (-1 where it can not be measured)
+
+	long peakResidentKilobytes()
+	{
+#ifdef __linux__
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_maxrss;
+#else
+		return -1;
+#endif
+	}
+
+	// Loads generated levels of growing size either tile by tile (patching an empty level) or in bulk. The peak RSS only ever grows, so run each mode in its own process to compare them
+
+	void load(bool isBulk)
+	{
+		std::cout << "tiles\t\t" << (isBulk ? "bulk" : "incremental") << " (ms)\tpeak RSS (KiB)\n";
+
+		for (int side : { 32, 100, 316, 1000 }) {
+			Config config{};
+			config.tilesize = 8;
+			config.worldscale = 4;
+			config.worldwidth = side;
+			config.worldheight = side;
+
+			auto next{ Generator::generate(side, side, 0, 0.0, 0.0) };
+
+			entt::registry registry{};
+			Physics::bodies(registry);
+
+			std::vector<entt::entity> entities{};
+			std::vector<std::string> tiles{};
+
+			auto start{ Clock::now() };
+
+			if (isBulk) {
+				Level::load(registry, entities, tiles, std::move(next), config);
+			}
+			else {
+				std::vector<std::size_t> changed{};
+				Level::patch(registry, entities, tiles, next, config, changed);
+			}
+
+			std::chrono::duration<double, std::milli> elapsed{ Clock::now() - start };
+
+			std::cout << side * side << "\t\t" << elapsed.count() << "\t\t" << peakResidentKilobytes() << '\n';
+		}
+	}
+
+	// Casts batches of random rays through a generated level on one thread and on every hardware thread
+
+	void raycast()
+	{
+		Config config{};
+		config.tilesize = 8;
+		config.worldscale = 4;
+		config.worldwidth = 1000;
+		config.worldheight = 1000;
+
+		auto grid{ Level::collisionGrid(Generator::generate(config.worldwidth, config.worldheight, 0, 0.0, 0.0), config) };
+		unsigned int threadcount{ std::max(1u, std::thread::hardware_concurrency()) };
+		Raycast::Workers workers{ threadcount };
+
+		std::cout << "rays\t\t1 thread (ns/ray)\t" << threadcount << " threads (ns/ray)\thits\n";
+
+		for (int count : { 1000, 10000, 100000 }) {
+			std::vector<Raycast::Ray> rays{};
+			std::vector<Raycast::Hit> hits{};
+			Random::mt.seed(count);
+
+			float worldpixels{ static_cast<float>(config.worldwidth * grid.cellsize) };
+
+			for (int i{ 0 }; i < count; ++i) {
+				rays.push_back(Raycast::Ray{ Random::get(0, static_cast<int>(worldpixels)) * 1.0f, Random::get(0, static_cast<int>(worldpixels) / 2) * 1.0f, Random::get(-100, 100) * 1.0f, Random::get(-100, 100) * 1.0f, 64.0f * grid.cellsize });
+			}
+
+			double single{ nanosecondsPerEntity([&]() { Raycast::castAll(grid, rays, hits); }, count, 10) };
+			double threaded{ nanosecondsPerEntity([&]() { Raycast::castAll(grid, rays, hits, workers); }, count, 10) };
+
+			std::cout << count << "\t\t" << single << "\t\t\t" << threaded << "\t\t\t" << std::count_if(hits.begin(), hits.end(), [](const Raycast::Hit& hit) { return hit.isHit; }) << '\n';
+		}
+	}
+
+	// Recomputes a flow field over a generated level, searches one only as far as a few chasers near the target, and looks up steps for many agents
+
+	void flowfield()
+	{
+		Config config{};
+		config.tilesize = 8;
+		config.worldscale = 4;
+
+		std::cout << "cells\t\trecompute (ms)\t16 chasers (ms)\tlookup (ns/agent)\tsteps taken\n";
+
+		for (int side : { 32, 100, 316, 1000 }) {
+			config.worldwidth = side;
+			config.worldheight = side;
+
+			auto grid{ Level::collisionGrid(Generator::generate(side, side, 0, 0.0, 0.0), config) };
+			Pathfinding::FlowField field{};
+
+			auto start{ Clock::now() };
+			field.update(grid, side / 2, 0);
+			std::chrono::duration<double, std::milli> elapsed{ Clock::now() - start };
+
+			Random::mt.seed(side);
+
+			std::vector<SDL_Point> chasers(16);
+			for (auto& chaser : chasers) {
+				chaser = SDL_Point{ std::clamp(side / 2 + Random::get(-16, 16), 0, side - 1), Random::get(0, std::min(side, 16) - 1) };
+			}
+
+			// Searched once from the next cell over first, so the timing is of a chase tick after the player moved and not of the first allocation
+
+			Pathfinding::FlowField bounded{};
+			bounded.update(grid, side / 2 - 1, 0, chasers);
+
+			start = Clock::now();
+			bounded.update(grid, side / 2, 0, chasers);
+			std::chrono::duration<double, std::milli> boundedelapsed{ Clock::now() - start };
+
+			int agents{ 100000 };
+			std::vector<SDL_Point> cells(agents);
+
+			for (auto& cell : cells) {
+				cell = SDL_Point{ Random::get(0, side - 1), Random::get(0, side - 1) };
+			}
+
+			int moving{ 0 };
+			double lookup{ nanosecondsPerEntity([&]() {
+				for (const auto& cell : cells) {
+					moving += field.step(cell.x, cell.y).x != 0;
+				}
+			}, agents, 10) };
+
+			std::cout << side * side << "\t\t" << elapsed.count() << "\t\t" << boundedelapsed.count() << "\t\t" << lookup << "\t\t\t" << moving << '\n';
+		}
+	}
+
+	// A behavior that wakes every few ticks, the smallest amount of work a script can do
+
+	Script::Behavior idle(int period, long long& wakeups)
+	{
+		while (true) {
+			co_await Script::waitTicks(period);
+			++wakeups;
+		}
+	}
+
+	// Advances animators cycling through a small clip table, with every other entity a static visual so the group has to be packed out of a mixed pool
+
+	void animation()
+	{
+		Animation::Clips clips{};
+		clips.clips.push_back(Animation::Clip{ 0, 4 });
+		for (int i{ 0 }; i < 4; ++i) {
+			clips.frames.push_back(Animation::Frame{ SDL_Rect{ i * 8, 0, 8, 8 }, static_cast<std::uint32_t>(1 + i) });
+		}
+
+		std::cout << "animators\tupdate (ns/animator)\n";
+
+		for (int count : { 1000, 10000, 100000, 1000000 }) {
+			entt::registry registry{};
+			Animation::animated(registry);
+
+			for (int i{ 0 }; i < count * 2; ++i) {
+				auto entity{ registry.create() };
+				registry.emplace<VisualComponent>(entity, Level::texture, SDL_Rect{}, SDL_Rect{}, SDL_FLIP_NONE);
+
+				if (i % 2 == 0) {
+					registry.emplace<AnimatorComponent>(entity, std::uint16_t{ 0 }, static_cast<std::uint16_t>(i % 4), 0u);
+				}
+			}
+
+			std::cout << count << "\t\t" << nanosecondsPerEntity([&]() { Animation::update(registry, clips); }, count, 100) << '\n';
+		}
+	}
+
+	// Ticks a scheduler full of idle behaviors
+
+	void scripts()
+	{
+		std::cout << "behaviors\ttick (us)\twakeups/tick\n";
+
+		for (int count : { 1000, 10000, 100000 }) {
+			entt::registry registry{};
+			Script::Scheduler scheduler{ registry };
+			long long wakeups{ 0 };
+
+			for (int i{ 0 }; i < count; ++i) {
+				scheduler.spawn(idle(1 + i % 4, wakeups));
+			}
+
+			int ticks{ 100 };
+			double perBehavior{ nanosecondsPerEntity([&]() { scheduler.tick(); }, count, ticks) };
+
+			std::cout << count << "\t\t" << perBehavior * count / 1000.0 << "\t\t" << wakeups / ticks << '\n';
+		}
+	}
+
+	// Loads a generated level with coins and movers, runs a few frames and prints the memory report as JSON
+
+	void memory()
+	{
+		Config config{};
+		config.tilesize = 8;
+		config.worldscale = 4;
+		config.worldwidth = 316;
+		config.worldheight = 316;
+
+		auto next{ Generator::generate(config.worldwidth, config.worldheight, 0, 0.002, 0.001) };
+
+		entt::registry registry{};
+		Physics::bodies(registry);
+		Physics::integrables(registry);
+
+		Memory::Accounting accounting{ registry };
+
+		std::vector<entt::entity> entities{};
+		std::vector<entt::entity> placed{};
+		std::vector<std::string> tiles{};
+
+		Level::load(registry, entities, tiles, std::move(next), config);
+		Level::spawnEntities(registry, tiles, config, placed);
+
+		Memory::Counts frame{};
+
+		for (int i{ 0 }; i < 60; ++i) {
+			auto start{ Memory::counts() };
+
+			Physics::integrate(registry);
+			Physics::updatePosition(registry, config);
+			registry.clear<MovedComponent>();
+
+			frame = Memory::counts() - start;
+		}
+
+		Memory::writeJson(std::cout, accounting.refresh(frame));
+	}
+
+	// Returns false if there is no benchmark by that name
+
+	bool run(std::string_view name)
+	{
+		if (name == "physics") {
+			physics();
+		}
+		else if (name == "integrator") {
+			integrator();
+		}
+		else if (name == "load-bulk") {
+			load(true);
+		}
+		else if (name == "load-incremental") {
+			load(false);
+		}
+		else if (name == "raycast") {
+			raycast();
+		}
+		else if (name == "flowfield") {
+			flowfield();
+		}
+		else if (name == "scripts") {
+			scripts();
+		}
+		else if (name == "memory") {
+			memory();
+		}
+		else if (name == "animation") {
+			animation();
+		}
+		else {
+			return false;
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	constexpr std::string_view linebreak{ "***********************************************\n" };
+
+	// '--generate <file> <width> <height> [seed] [coindensity] [moverdensity]' writes a procedural level and exits. Set worldwidth and worldheight in the config to match before loading it
+
+	if (argc > 4 && std::string_view{ argv[1] } == "--generate") {
+		try {
+			int width{ std::stoi(argv[3]) };
+			int height{ std::stoi(argv[4]) };
+			unsigned int seed{ argc > 5 ? static_cast<unsigned int>(std::stoul(argv[5])) : 0u };
+			double coindensity{ argc > 6 ? std::stod(argv[6]) : 0.002 };
+			double moverdensity{ argc > 7 ? std::stod(argv[7]) : 0.0 };
+
+			if (width <= 0 || height <= 0) {
+				throw std::invalid_argument("size");
+			}
+
+			if (!Generator::write(argv[2], Generator::generate(width, height, seed, coindensity, moverdensity), width)) {
+				return 1;
+			}
+
+			std::cout << "Level generated...('" << argv[2] << "', " << width << 'x' << height << ", seed " << seed << ")\n";
+		}
+		catch (const std::exception& error) {
+			std::cerr << "Invalid arguments for --generate...(" << error.what() << ")\n";
+			return 1;
+		}
+
+		return 0;
+	}
+
+	if (argc > 2 && std::string_view{ argv[1] } == "--bench") {
+		if (!Benchmark::run(argv[2])) {
+			std::cerr << "Unknown benchmark...('" << argv[2] << "')\n";
+			return 1;
+		}
+
+		return 0;
+	}
+
+	// '--render <frames> [directory]' runs without a window. The Render System draws into an off-screen surface with the software renderer, as fast as it can, and the draw calls and milliseconds per frame are printed at the end. Given a directory, every frame is also written there as a PNG for pixel-diff tests
+
+	int offscreenframes{ 0 };
+	std::string framedirectory{};
+
+	if (argc > 2 && std::string_view{ argv[1] } == "--render") {
+		try {
+			offscreenframes = std::stoi(argv[2]);
+
+			if (offscreenframes <= 0) {
+				throw std::invalid_argument("frames");
+			}
+		}
+		catch (const std::exception& error) {
+			std::cerr << "Invalid arguments for --render...(" << error.what() << ")\n";
+			return 1;
+		}
+
+		if (argc > 3) {
+			framedirectory = argv[3];
+		}
+	}
+
+	bool isOffscreen{ offscreenframes > 0 };
+
+	try {
+		// <INIT>
+		std::cout << "<INIT>\n";
+		{
+			// Off-screen runs need no display, so the video subsystem is left out for display-less machines
+
+			if (SDL_Init(isOffscreen ? SDL_INIT_TIMER | SDL_INIT_EVENTS : SDL_INIT_EVERYTHING) == 0) {
+				std::cout << "SDL initialized...\n";
+			}
+			else {
+				std::cerr << "SDL_Init(): " << SDL_GetError() << '\n';
+				throw std::runtime_error("Init failed");
+			}
+
+			if (IMG_Init(IMG_INIT_PNG) == IMG_INIT_PNG) {
+				std::cout << "SDL_image initialized...\n";
+			}
+			else {
+				std::cerr << "IMG_Init(): " << IMG_GetError() << '\n';
+				throw std::runtime_error("Init failed");
+			}
+		}
+
+		std::cout << linebreak;
+
+		// <CONFIG>
+		std::cout << "<CONFIG>\n";
+
+		Config config{};
+
+		std::string configfile{ "assets/config.txt" };
+
+		if (!readConfig(configfile, config)) {
+			throw std::runtime_error("Config failed");
+		}
+
+		// The rest of the program reads the config through these, so values applied by a hot reload are picked up everywhere
+
+		std::string& name{ config.name };
+		int& tilesize{ config.tilesize };
+		int& worldwidth{ config.worldwidth };
+		int& worldheight{ config.worldheight };
+		int& worldscale{ config.worldscale };
+		int& viewwidth{ config.viewwidth };
+		int& viewheight{ config.viewheight };
+		bool& fused{ config.fused };
+		Uint32& windowflags{ config.windowflags };
+		Uint32& rendererflags{ config.rendererflags };
+
+		std::cout << "name\t\t==\t" << name << '\n'
+			<< "tilesize\t==\t" << tilesize << '\n'
+			<< "worldwidth\t==\t" << worldwidth << '\n'
+			<< "worldheight\t==\t" << worldheight << '\n'
+			<< "worldscale\t==\t" << worldscale << '\n'
+			<< "viewwidth\t==\t" << viewwidth << '\n'
+			<< "viewheight\t==\t" << viewheight << '\n'
+			<< "integrator\t==\t" << (fused ? "fused" : "separate") << '\n';
+
+		std::cout << "windowflags\t==\t";
+		if (windowflags && SDL_WINDOW_FULLSCREEN) {
+			std::cout << "SDL_WINDOW_FULLSCREEN\n";
+		}
+		else {
+			std::cout << '\n';
+		}
+
+		std::cout << "rendererflags\t==\t";
+		if (rendererflags && SDL_RENDERER_ACCELERATED) {
+			std::cout << "SDL_RENDERER_ACCELERATED\n";
+		}
+		else {
+			std::cout << "NONE\n";
+		}
+
+		std::cout << linebreak;
+
+		// <SETUP>
+		std::cout << "<SETUP>\n";
+
+		entt::registry registry{};
+		std::cout << "Registry created...\n";
+
+		Physics::bodies(registry);
+		Physics::integrables(registry);
+		std::cout << "Physics groups created...\n";
+
+		Animation::animated(registry);
+		std::cout << "Animation group created...\n";
+
+		Memory::Accounting accounting{ registry };
+
+		Triggers::Index triggerindex{};
+		Triggers::Tracker triggertracker{};
+		triggerindex.connect(registry);
+		triggerindex.reset(tilesize * worldscale, worldwidth, worldheight);
+		std::cout << "Trigger index created...\n";
+
+		entt::dispatcher dispatcher{};
+		CoinCollector coincollector{ registry, config };
+		dispatcher.sink<Triggers::Enter>().connect<&CoinCollector::onEnter>(coincollector);
 
-		// <SETUP>
-		std::cout << "<SETUP>\n";
+		SDL_Window* window{ nullptr };
+		SDL_Surface* surface{ nullptr };
+		SDL_Renderer* renderer{ nullptr };
 
-		entt::registry registry{};
-		std::cout << "Registry created...\n";
+		if (isOffscreen) {
+			surface = SDL_CreateRGBSurfaceWithFormat(0, tilesize * worldscale * viewwidth, tilesize * worldscale * viewheight, 32, SDL_PIXELFORMAT_RGBA32);
+			if (surface) {
+				std::cout << "Surface created...\n";
+			}
+			else {
+				std::cerr << "SDL_CreateRGBSurfaceWithFormat(): " << SDL_GetError() << '\n';
+				throw std::runtime_error("Setup failed");
+			}
 
-		SDL_Window* window{ SDL_CreateWindow(name.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, tilesize * worldscale * worldwidth, tilesize * worldscale * worldheight, windowflags) };
-		if (window) {
-			std::cout << "Window created...\n";
+			renderer = SDL_CreateSoftwareRenderer(surface);
 		}
 		else {
-			std::cerr << "SDL_CreateWindow(): " << SDL_GetError() << '\n';
-			throw std::runtime_error("Setup failed");
+			window = SDL_CreateWindow(name.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, tilesize * worldscale * viewwidth, tilesize * worldscale * viewheight, windowflags);
+			if (window) {
+				std::cout << "Window created...\n";
+			}
+			else {
+				std::cerr << "SDL_CreateWindow(): " << SDL_GetError() << '\n';
+				throw std::runtime_error("Setup failed");
+			}
+
+			renderer = SDL_CreateRenderer(window, -1, rendererflags);
 		}
 
-		SDL_Renderer* renderer{ SDL_CreateRenderer(window, -1, rendererflags) };
 		if (renderer) {
 			std::cout << "Renderer created...\n";
 		}
@@ -324,9 +3605,9 @@ int main(int argc, char *argv[]) {
 			throw std::runtime_error("Failed SDL_CreateRenderer()");
 		}
 
-		std::unordered_map<std::string, SDL_Texture*> textures{};
+		std::unordered_map<std::string_view, SDL_Texture*> textures{};
 
-		std::string texturefile{ "assets/texture.png" };
+		std::string texturefile{ Level::texture };
 
 		SDL_Texture* texture{ IMG_LoadTexture(renderer, texturefile.c_str()) };
 
@@ -340,7 +3621,7 @@ int main(int argc, char *argv[]) {
 			throw std::runtime_error("Setup failed");
 		}
 
-		textures.emplace(texturefile, texture);
+		textures.emplace(Level::texture, texture);
 
 		int playerwidth{ 4 * worldscale};
 		int playerheight{ 8 * worldscale };
@@ -350,7 +3631,7 @@ int main(int argc, char *argv[]) {
 		int spriteY{ 7 * tilesize };
 
 		auto player{ registry.create() };
-		registry.emplace<VisualComponent>(player, "assets/texture.png", SDL_Rect{ spriteX, spriteY, tilesize / 2, tilesize }, SDL_Rect{ locationX, locationY, tilesize * worldscale / 2, tilesize * worldscale }, SDL_FLIP_NONE);
+		registry.emplace<VisualComponent>(player, Level::texture, SDL_Rect{ spriteX, spriteY, tilesize / 2, tilesize }, SDL_Rect{ locationX, locationY, tilesize * worldscale / 2, tilesize * worldscale }, SDL_FLIP_NONE);
 		registry.emplace<SpatialComponent>(player, locationX, locationY, playerwidth, playerheight);
 		registry.emplace<VelocityComponent>(player);
 		registry.emplace<AccelerationComponent>(player);
@@ -359,181 +3640,61 @@ int main(int argc, char *argv[]) {
 		registry.emplace<JumpComponent>(player, false, 12.0f, 0);
 		registry.emplace<RunComponent>(player, 4.0f, 2.0f, 1.0f);
 		registry.emplace<AccumulatorComponent>(player);
-		registry.emplace<DebugComponent>(player, true);
-
-		int coinwidth{ 4 * worldscale };
-		int coinheight{ 4 * worldscale };
-		int coinLocationX{ 0 };
-		int coinLocationY{ 0 };
-		int coinSpriteX{ 0 * tilesize / 2 };
-		int coinSpriteY{ 12 * tilesize / 2 };
+		registry.emplace<SpriteComponent>(player);
+		registry.emplace<DebugComponent>(player);
 
-		auto coin{ registry.create() };
-		registry.emplace<VisualComponent>(coin, "assets/texture.png", SDL_Rect{coinSpriteX, coinSpriteY, tilesize / 2, tilesize / 2 }, SDL_Rect{ coinLocationX, coinLocationY, tilesize * worldscale / 2, tilesize * worldscale / 2});
-		registry.emplace<CollectableComponent>(coin, coinLocationX, coinLocationY, coinwidth, coinheight);
-		registry.emplace<DebugComponent>(coin, true);
+		auto camera{ registry.create() };
+		registry.emplace<CameraComponent>(camera, 0, 0, tilesize * worldscale * viewwidth, tilesize * worldscale * viewheight, player);
 
-		std::string levelfile{ "assets/level_1.txt" };
+		auto coin{ Level::spawnCoin(registry, 0, 0, config) };
 
-		inFile.open(levelfile);
-		if (inFile.is_open()) {
-			std::cout << "File opened...('" << levelfile << "')\n";
-		}
-		else {
-			std::cerr << "File failed to load...('" << levelfile << "')\n";
-			throw std::runtime_error("Setup failed");
-		}
+		std::string levelfile{ config.level };
 
-		int tilecol{ 0 };
-		int tilerow{ 0 };
+		std::vector<std::string> tiles{};
+		std::vector<entt::entity> tileentities{};
+		std::vector<entt::entity> placedentities{}; // The coins and movers the level placed
+		std::vector<std::size_t> changedcells{}; // The cells the last level hot reload patched
 
-		while (inFile >> current) {
-			SDL_Point filepoint{ -1, -1 };
-			bool isCollidable{ false };
+		{
+			std::vector<std::string> nexttiles{};
 
-			if (current == "w") {
-				filepoint = { 2, 1 };
-				isCollidable = true;
-			}
-			else if (current == "wl") {
-				filepoint = { 3, 1 };
-				isCollidable = true;
-			}
-			else if (current == "wr") {
-				filepoint = { 1, 1 };
-				isCollidable = true;
-			}
-			else if (current == "wd") {
-				filepoint = { 2, 0 };
-				isCollidable = true;
-			}
-			else if (current == "wu") {
-				filepoint = { 2, 2 };
-				isCollidable = true;
-			}
-			else if (current == "wld") {
-				filepoint = { 3, 0 };
-				isCollidable = true;
-			}
-			else if (current == "wrd") {
-				filepoint = { 1, 0 };
-				isCollidable = true;
-			}
-			else if (current == "wlu") {
-				filepoint = { 3, 2 };
-				isCollidable = true;
-			}
-			else if (current == "wru") {
-				filepoint = { 1, 2 };
-				isCollidable = true;
-			}
-			else if (current == "vld") {
-				filepoint = { 1, 4 };
-				isCollidable = true;
-			}
-			else if (current == "vrd") {
-				filepoint = { 2, 4 };
-				isCollidable = true;
-			}
-			else if (current == "vlu") {
-				filepoint = { 1, 3 };
-				isCollidable = true;
-			}
-			else if (current == "vru") {
-				filepoint = { 2, 3 };
-				isCollidable = true;
-			}
-			else if (current == "s") {
-				filepoint = { 5, 1 };
-				isCollidable = false;
-			}
-			else if (current == "sc") {
-				filepoint = { 5, 0 };
-				isCollidable = false;
-			}
-			else if (current == "sb") {
-				filepoint = { 4, 0 };
-				isCollidable = false;
-			}
-			else if (current == "stl") {
-				filepoint = { 4, 1 };
-				isCollidable = false;
-			}
-			else if (current == "str") {
-				filepoint = { 6, 1 };
-				isCollidable = false;
-			}
-			else if (current == "s1") {
-				filepoint = { 6, 0 };
-				isCollidable = false;
-			}
-			else if (current == "s2") {
-				filepoint = { 4, 2 };
-				isCollidable = false;
-			}
-			else if (current == "s3") {
-				filepoint = { 5, 2 };
-				isCollidable = false;
-			}
-			else if (current == "s4") {
-				filepoint = { 6, 2 };
-				isCollidable = false;
-			}
-			else if (current == "wf") {
-				filepoint = { 3, 3 };
-				isCollidable = true;
-			}
-			else if (current == "wbu") {
-				filepoint = { 3, 5 };
-				isCollidable = true;
-			}
-			else if (current == "wbd") {
-				filepoint = { 3, 4 };
-				isCollidable = true;
-			}
-			else if (current == "wbl") {
-				filepoint = { 2, 5 };
-				isCollidable = true;
-			}
-			else if (current == "wbr") {
-			filepoint = { 1, 5 };
-			isCollidable = true;
+			if (!Level::read(levelfile, worldwidth, worldheight, nexttiles)) {
+				throw std::runtime_error("Setup failed");
 			}
 
-			if (filepoint.x != -1 && filepoint.y != -1)
-			{
-				auto tile{ registry.create() };
+			Level::load(registry, tileentities, tiles, std::move(nexttiles), config);
+			Level::spawnEntities(registry, tiles, config, placedentities);
+		}
 
-				std::string texturename{ "assets/texture.png" };
-				SDL_Rect srcRect{ filepoint.x * tilesize, filepoint.y * tilesize, tilesize, tilesize };
-				SDL_Rect dstRect{ tilecol * tilesize * worldscale, tilerow * tilesize * worldscale, tilesize * worldscale, tilesize * worldscale };
-				registry.emplace<VisualComponent>(tile, texturename, srcRect, dstRect, SDL_FLIP_NONE);
+		// Without a clip table nothing is animated, the sprites keep their static srcRect
 
-				if (isCollidable) {
-					int x{ dstRect.x };
-					int y{ dstRect.y };
-					int w{ dstRect.w };
-					int h{ dstRect.h };
+		Animation::Clips clips{};
+		Animation::read(config.animations, clips);
+		Animation::attach(registry, tileentities, tiles, clips);
 
-					registry.emplace<SpatialComponent>(tile, x, y, w, h);
-					registry.emplace<DebugComponent>(tile, true);
-				}
+		int runclip{ clips.find("run") };
+		int idleclip{ clips.find("idle") };
 
-				tilecol += 1;
+		Level::CollisionGrid collisiongrid{ Level::collisionGrid(tiles, config) };
+		Pathfinding::FlowField flowfield{};
+		std::vector<SDL_Point> chasercells{}; // The cells the chasers stand in, reused every tick
 
-				if (!(tilecol <  worldwidth)) {
-					tilecol = 0;
-					tilerow += 1;
-				}
-			}
-		}
+		// Off-screen runs must render the same frames every time, so nothing on disk is allowed to change them while running
 
-		inFile.close();
-		std::cout << "File closed...('" << levelfile << "')\n";
+		AssetWatcher watcher{ isOffscreen ? std::string{} : std::string{ "assets" } };
+		if (watcher.isWatching()) {
+			std::cout << "Watching assets...('assets')\n";
+		}
 
 		std::cout << linebreak;
 
-		Random::randomizeCoinLocation(registry, worldwidth, worldheight, worldscale * tilesize);
+		// Off-screen runs are compared pixel by pixel, so every run places the default coin the same way
+
+		if (isOffscreen) {
+			Random::mt.seed(0);
+		}
+
+		Random::randomizeCoinLocation(registry, coin, worldwidth, worldheight, worldscale * tilesize);
 
 		// <RUN>
 		std::cout << "<RUN>\n";
@@ -542,298 +3703,315 @@ int main(int argc, char *argv[]) {
 
 		bool isRunning{ true };
 
-		SDL_Event event{};
+		Script::Scheduler scheduler{ registry };
+		scheduler.spawn(winCondition(registry, player, coinsToWin, isRunning), player);
 
-		while (isRunning) {
+		Input::State input{};
 
-			// Input
-			{
-				while (SDL_PollEvent(&event) != 0) {
-					auto runview{ registry.view<VelocityComponent, RunComponent>() };
-					auto jumpview{ registry.view <VelocityComponent, JumpComponent>() };
-					auto visualview{ registry.view <RunComponent, VisualComponent>() };
-					auto debugview{ registry.view<DebugComponent>() };
-					auto keyboard{ SDL_GetKeyboardState(nullptr) };
-
-					switch (event.type)
-					{
-					case SDL_QUIT:
-						isRunning = false;
-						break;
+		// The overlay shows timing-dependent values (the allocations of the last frame), so it is left off in off-screen runs
 
-					case SDL_KEYDOWN:
-						if (!event.key.repeat) {
-							// std::cout << event.key.keysym.scancode << "\tjust pressed\n";
+		bool isDebugging{ !isOffscreen };
+		DebugOverlay overlay{};
 
-							switch (event.key.keysym.scancode) {
-							case SDL_SCANCODE_SPACE:
+		int renderedframes{ 0 };
+		long long drawcalls{ 0 };
+		std::chrono::duration<double, std::milli> rendertime{ 0 };
+		auto runstart{ std::chrono::steady_clock::now() };
 
-								for (auto entity : jumpview) {
-									auto& velocity{ registry.get<VelocityComponent>(entity) };
-									auto& jump{ registry.get<JumpComponent>(entity) };
+		FrameWatchdog watchdog{ config.incidentfile, config.incidentslots };
 
-									if (jump.canJump) {
-										velocity.y = -jump.strength;
-									}
-								}
+		Memory::Counts lastframe{};
 
-								break;
+		while (isRunning) {
+			watchdog.beginFrame();
+			auto framestart{ Memory::counts() };
 
-							case SDL_SCANCODE_A:
+			// Hot Reload System (applies assets that changed on disk since the last frame)
+			{
+				auto timer{ watchdog.measure("Hot Reload System") };
 
-								for (auto entity : runview) {
-									auto& velocity{ registry.get<VelocityComponent>(entity) };
-									if (!keyboard[SDL_SCANCODE_D]) {
-										velocity.x = -4;
-									}
-								}
+				for (const auto& file : watcher.poll()) {
+					if (file == configfile) {
+						Config next{};
 
-								for (auto entity : visualview) {
-									auto& visual{ registry.get<VisualComponent>(entity) };
-									if (!keyboard[SDL_SCANCODE_D]) {
-										visual.flip = SDL_FLIP_NONE;
-									}
-								}
+						if (!readConfig(configfile, next)) {
+							continue;
+						}
 
-								break;
+						bool isReshaped{ next.tilesize != tilesize || next.worldscale != worldscale || next.worldwidth != worldwidth || next.worldheight != worldheight || next.level != levelfile };
+						bool isRefitted{ next.tilesize != tilesize || next.worldscale != worldscale || next.viewwidth != viewwidth || next.viewheight != viewheight };
 
-							case SDL_SCANCODE_D:
+						// The tile grid, the collision grid and the renderer all assume the level fills the world, so a reshaped config is only applied once its level has been read
 
-								for (auto entity : runview) {
-									auto& velocity{ registry.get<VelocityComponent>(entity) };
-									if (!keyboard[SDL_SCANCODE_A]) {
-										velocity.x = 4;
-									}
-								}
+						std::vector<std::string> nexttiles{};
 
-								for (auto entity : visualview) {
-									auto& visual{ registry.get<VisualComponent>(entity) };
-									if (!keyboard[SDL_SCANCODE_A]) {
-										visual.flip = SDL_FLIP_HORIZONTAL;
-									}
-								}
+						if (isReshaped && !Level::read(next.level, next.worldwidth, next.worldheight, nexttiles)) {
+							std::cerr << "Config not applied, its level failed to load...('" << configfile << "')\n";
+							continue;
+						}
 
-								break;
+						if (next.name != name) {
+							SDL_SetWindowTitle(window, next.name.c_str());
+						}
 
-							case SDL_SCANCODE_F3:
+						if (next.windowflags != windowflags) {
+							SDL_SetWindowFullscreen(window, next.windowflags & SDL_WINDOW_FULLSCREEN);
+						}
 
-								for (auto entity : debugview) {
-									auto& debug{ registry.get<DebugComponent>(entity) };
-									debug.toggle = !debug.toggle;
-									std::cout << "Debug(entity: " << static_cast<int>(entity) << ")\t==\t" << std::boolalpha << debug.toggle << '\n';
-								}
+						if (next.rendererflags != rendererflags) {
+							std::cout << "rendererflags can not be applied live, restart to apply them...\n";
+							next.rendererflags = rendererflags;
+						}
 
-								break;
+						config = next;
+						levelfile = config.level;
 
-							case SDL_SCANCODE_F11:
+						if (isRefitted) {
+							SDL_SetWindowSize(window, tilesize * worldscale * viewwidth, tilesize * worldscale * viewheight);
 
-								if (SDL_GetWindowFlags(window) & SDL_WINDOW_FULLSCREEN_DESKTOP) {
-									SDL_SetWindowFullscreen(window, 0);
-								}
-								else {
-									SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN_DESKTOP);
-								}
+							auto& cameradata{ registry.get<CameraComponent>(camera) };
+							cameradata.w = tilesize * worldscale * viewwidth;
+							cameradata.h = tilesize * worldscale * viewheight;
+						}
 
-								break;
+						if (isReshaped) {
 
-							case SDL_SCANCODE_C:
+							auto& playerspatial{ registry.get<SpatialComponent>(player) };
+							auto& playervisual{ registry.get<VisualComponent>(player) };
+							playerspatial.w = 4 * worldscale;
+							playerspatial.h = 8 * worldscale;
+							playervisual.srcRect = SDL_Rect{ 4 * tilesize, 7 * tilesize, tilesize / 2, tilesize };
+							playervisual.dstRect.w = tilesize * worldscale / 2;
+							playervisual.dstRect.h = tilesize * worldscale;
 
-								Random::randomizeCoinLocation(registry, worldwidth, worldheight, worldscale * tilesize);
+							auto& coincollectable{ registry.get<CollectableComponent>(coin) };
+							auto& coinvisual{ registry.get<VisualComponent>(coin) };
+							coincollectable.w = 4 * worldscale;
+							coincollectable.h = 4 * worldscale;
+							coinvisual.srcRect = SDL_Rect{ 0 * tilesize / 2, 12 * tilesize / 2, tilesize / 2, tilesize / 2 };
+							coinvisual.dstRect.w = tilesize * worldscale / 2;
+							coinvisual.dstRect.h = tilesize * worldscale / 2;
 
-								break;
+							triggerindex.reset(tilesize * worldscale, worldwidth, worldheight);
 
-							default:
-								break;
-							}
+							// Every tile, coin and mover depends on the grid shape and scale, so the level is respawned from scratch
+
+							Level::despawnEntities(registry, placedentities);
+							Level::load(registry, tileentities, tiles, std::move(nexttiles), config);
+							Level::spawnEntities(registry, tiles, config, placedentities);
+							Animation::attach(registry, tileentities, tiles, clips);
+
+							collisiongrid = Level::collisionGrid(tiles, config);
+							flowfield.invalidate();
+
+							// Placed coins stay where the level put them, only the default coin is rolled again
+
+							Random::randomizeCoinLocation(registry, coin, worldwidth, worldheight, worldscale * tilesize);
 						}
-						break;
 
-					case SDL_KEYUP:
-						// std::cout << event.key.keysym.scancode << "\tjust released\n";
+						std::cout << "Config reloaded...('" << configfile << "')\n";
+					}
+					else if (file == levelfile) {
+						std::vector<std::string> nexttiles{};
 
-						switch (event.key.keysym.scancode) {
-						case SDL_SCANCODE_A:
+						if (Level::read(levelfile, worldwidth, worldheight, nexttiles)) {
+							int patched{ Level::patch(registry, tileentities, tiles, nexttiles, config, changedcells) };
+							std::cout << "Level reloaded, " << patched << " tiles patched...('" << levelfile << "')\n";
 
-							for (auto entity : runview) {
-								auto& velocity{ registry.get<VelocityComponent>(entity) };
-								if (keyboard[SDL_SCANCODE_D]) {
-									velocity.x = 4;
-								}
-								else {
-									velocity.x = 0;
-								}
-							}
+							Animation::attach(registry, tileentities, tiles, changedcells, clips);
+							Level::patchCollisionGrid(collisiongrid, tiles, changedcells, config);
 
-							break;
+							if (patched) {
+								flowfield.invalidate();
+							}
 
-						case SDL_SCANCODE_D:
+							// A patched tile may have been placed on top of the default coin
 
-							for (auto entity : runview) {
-								auto& velocity{ registry.get<VelocityComponent>(entity) };
-								if (keyboard[SDL_SCANCODE_A]) {
-									velocity.x = -4;
-								}
-								else {
-									velocity.x = 0;
-								}
+							if (patched) {
+								Random::randomizeCoinLocation(registry, coin, worldwidth, worldheight, worldscale * tilesize);
 							}
+						}
+					}
+					else if (file == config.animations) {
+
+						// Clip ids may have changed, so every animator is dropped and attached again
 
-							break;
+						if (Animation::read(config.animations, clips)) {
+							registry.clear<AnimatorComponent>();
+							Animation::attach(registry, tileentities, tiles, clips);
 
-						default:
-							break;
+							runclip = clips.find("run");
+							idleclip = clips.find("idle");
+
+							std::cout << "Animations reloaded...('" << config.animations << "')\n";
 						}
-						break;
+					}
+					else if (textures.count(file)) {
+						SDL_Texture* reloaded{ IMG_LoadTexture(renderer, file.c_str()) };
 
-					default:
-						break;
+						if (reloaded) {
+							SDL_DestroyTexture(textures.at(file));
+							textures.at(file) = reloaded;
+							std::cout << "Texture reloaded...('" << file << "')\n";
+						}
+						else {
+							std::cerr << "IMG_LoadTexture(): " << IMG_GetError() << '\n';
+						}
 					}
 				}
 			}
 
-			// Update
+			// Input
 			{
-				// Apply Gravity To Velocity System
-				{
-					auto view{ registry.view<VelocityComponent, GravityComponent>() };
+				auto timer{ watchdog.measure("Input") };
+
+				Input::poll(input, config.bindings);
+
+				if (input.quit) {
+					isRunning = false;
+				}
+			}
+
+			// Input System (applies this tick's action state)
+			{
+				auto timer{ watchdog.measure("Input System") };
 
-					for (auto entity : view) {
-						auto& velocity{ registry.get<VelocityComponent>(entity) };
-						const auto& gravity{ registry.get<GravityComponent>(entity) };
+				auto runview{ registry.view<VelocityComponent, RunComponent>() };
+				auto jumpview{ registry.view<VelocityComponent, JumpComponent>() };
+				auto visualview{ registry.view<RunComponent, VisualComponent>() };
+				auto animatorview{ registry.view<RunComponent, AnimatorComponent>() };
 
-						velocity.y += gravity.g;
+				for (auto [entity, velocity, run] : runview.each()) {
+					velocity.x = input.run * run.speed;
+				}
+
+				for (auto [entity, run, visual] : visualview.each()) {
+					if (input.run < 0) {
+						visual.flip = SDL_FLIP_NONE;
+					}
+					else if (input.run > 0) {
+						visual.flip = SDL_FLIP_HORIZONTAL;
 					}
 				}
 
-				// Apply Acceleration To Velocity System
-				{
-					auto view{ registry.view<VelocityComponent, AccelerationComponent>() };
+				for (auto [entity, run, animator] : animatorview.each()) {
+					Animation::play(animator, input.run != 0 ? runclip : idleclip);
+				}
 
-					for (auto entity : view) {
-						auto& velocity{ registry.get<VelocityComponent>(entity) };
-						const auto& acceleration{ registry.get<AccelerationComponent>(entity) };
+				// *Jumps pressed shortly before landing are buffered and fire as soon as the entity can jump*
 
-						velocity.x += acceleration.x;
-						velocity.y += acceleration.y;
+				for (auto [entity, velocity, jump] : jumpview.each()) {
+					if (input.pressed[Input::Jump]) {
+						jump.buffer = std::max(1, config.jumpbuffer);
+					}
 
-						if (velocity.x > 16) {
-							velocity.x = 16;
+					if (jump.buffer > 0) {
+						if (jump.canJump) {
+							velocity.y = -jump.strength;
+							jump.buffer = 0;
 						}
-						if (velocity.y > 16) {
-							velocity.y = 16;
+						else {
+							--jump.buffer;
 						}
 					}
 				}
 
-				// Apply Velocty To Move System
-				{
-					auto view{ registry.view<VelocityComponent, MoveComponent>() };
-
-					for (auto entity : view) {
-						auto& move{ registry.get<MoveComponent>(entity) };
-						const auto& velocity{ registry.get<VelocityComponent>(entity) };
+				if (input.pressed[Input::Debug]) {
+					isDebugging = !isDebugging;
+					std::cout << "Debug\t==\t" << std::boolalpha << isDebugging << '\n';
 
-						move.xr += velocity.x;
-						move.yr += velocity.y;
-
-						move.x = static_cast<int>(std::round(move.xr));
-						move.y = static_cast<int>(std::round(move.yr));
+					// The overlay only shows the memory report as bars, so the numbers go to the console
+					if (isDebugging) {
+						Memory::writeJson(std::cout, accounting.refresh(lastframe));
+					}
+				}
 
-						move.xr -= move.x;
-						move.yr -= move.y;
+				if (input.pressed[Input::Fullscreen]) {
+					if (SDL_GetWindowFlags(window) & SDL_WINDOW_FULLSCREEN_DESKTOP) {
+						SDL_SetWindowFullscreen(window, 0);
+					}
+					else {
+						SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN_DESKTOP);
 					}
 				}
 
-				// Update Position System
+				if (input.pressed[Input::Respawn]) {
+					Random::randomizeCoinLocation(registry, coin, worldwidth, worldheight, worldscale * tilesize);
+				}
+			}
+
+			// Update
+			{
+				// Chase System
 				{
-					auto view1{ registry.view<MoveComponent, SpatialComponent>() };
-					auto view2{ registry.view<SpatialComponent>() };
-
-					for (auto entity1 : view1) {
-						auto& spatial1{ registry.get<SpatialComponent>(entity1) };
-						auto& move1{ registry.get<MoveComponent>(entity1) };
-
-						// Move along the Y-axis one pixel at a time and test for collisions every step, only moving if there is nothing ahead
-						{
-							int sign{ (move1.y > 0) - (move1.y < 0) }; // Computes the sign (or false if still) of the Y-vector. Either 1 (downwards), 0 (still) or -1 (upwards)
-							bool stop{ false };
-
-							while (move1.y) {
-								for (auto entity2 : view2) {
-									if (entity2 != entity1) {
-										const auto& spatial2{ registry.get<SpatialComponent>(entity2) };
-
-										if (collideAt(spatial1, spatial2, Vector2D{ 0, sign })) {
-											stop = true;
-										}
-									}
-								}
+					auto timer{ watchdog.measure("Chase System") };
 
-								if (!stop) {
-									spatial1.y += sign;
-									move1.y -= sign;
-								}
-								else {
-									break;
-								}
-							}
-						}
+					const auto& target{ registry.get<SpatialComponent>(player) };
+					int cellsize{ collisiongrid.cellsize };
 
-						// Move along the X-axis one pixel at a time and test for collisions every step, only moving if there is nothing ahead
-						{
-							int sign{ (move1.x > 0) - (move1.x < 0) }; // Computes the sign (or false if still) of the X-vector. Either 1 (right), 0 (still) or -1 (left)
-							bool stop{ false };
+					auto view{ registry.view<ChaseComponent, VelocityComponent, SpatialComponent>() };
 
-							while (move1.x) {
-								for (auto entity2 : view2) {
-									if (entity2 != entity1) {
-										const auto& spatial2{ registry.get<SpatialComponent>(entity2) };
+					chasercells.clear();
+					for (auto [entity, chase, velocity, spatial] : view.each()) {
+						chasercells.push_back(SDL_Point{ (spatial.x + spatial.w / 2) / cellsize, (spatial.y + spatial.h / 2) / cellsize });
+					}
 
-										if (collideAt(spatial1, spatial2, Vector2D{ sign, 0 })) {
-											stop = true;
-										}
-									}
-								}
+					// The field is only searched as far as the chasers, and not at all without any
 
-								if (!stop) {
-									spatial1.x += sign;
-									move1.x -= sign;
-								}
-								else {
-									break;
-								}
-							}
+					if (!chasercells.empty()) {
+						flowfield.update(collisiongrid, (target.x + target.w / 2) / cellsize, (target.y + target.h / 2) / cellsize, chasercells);
+
+						// *Chasers walk along the flow field toward the player, and keep walking where it points up or down*
+
+						std::size_t chaser{ 0 };
+						for (auto [entity, chase, velocity, spatial] : view.each()) {
+							int step{ flowfield.horizontalStep(chasercells[chaser].x, chasercells[chaser].y) };
+							velocity.x = step * chase.speed;
+							++chaser;
 						}
+					}
+				}
 
+				if (fused) {
+					// Integration System (gravity, acceleration and velocity in one pass)
+					auto timer{ watchdog.measure("Integration System") };
+					Physics::integrate(registry);
+				}
+				else {
+					auto timer{ watchdog.measure("Integration Systems") };
 
-					
+					// Apply Gravity To Velocity System
+					Physics::applyGravity(registry);
 
-						// Window Bounds. Make sure nothing can move outside the window frame
-						if (spatial1.x < 0) spatial1.x = 0;
-						if (spatial1.y < 0) spatial1.y = 0;
-						if (spatial1.x + spatial1.w > tilesize * worldscale * worldwidth) spatial1.x = tilesize * worldscale * worldwidth - spatial1.w;
-						if (spatial1.y + spatial1.h > tilesize * worldscale * worldheight) spatial1.y = tilesize * worldscale * worldheight - spatial1.h;
-					}
+					// Apply Acceleration To Velocity System
+					Physics::applyAcceleration(registry);
 
+					// Apply Velocty To Move System
+					Physics::applyVelocity(registry);
+				}
+
+				// Update Position System
+				{
+					{
+						auto timer{ watchdog.measure("Update Position System") };
+						Physics::updatePosition(registry, config);
+					}
 
 					// Grounded Check System
 					{
+						auto timer{ watchdog.measure("Grounded Check System") };
+
 						auto jumpview{ registry.view<JumpComponent, SpatialComponent>() };
 						auto velocityview{ registry.view<VelocityComponent, SpatialComponent>() };
 						auto floorview{ registry.view<SpatialComponent>() };
 
 						// *If grounded entity can jump*
 
-						for (auto jump : jumpview) {
-							auto& jumpdata{ registry.get<JumpComponent>(jump) };
-							auto& positiondata{ registry.get<SpatialComponent>(jump) };
-
+						for (auto [jump, jumpdata, positiondata] : jumpview.each()) {
 							jumpdata.canJump = false;
 
-							for (auto floor : floorview) {
+							for (auto [floor, floordata] : floorview.each()) {
 								if (jump != floor) {
-									auto& floordata{ registry.get<SpatialComponent>(floor) };
-
 									if (collideAt(positiondata, floordata, Vector2D{ 0, 1 })) {
 										jumpdata.canJump = true;
 									}
@@ -843,14 +4021,9 @@ int main(int argc, char *argv[]) {
 
 						// *If grounded entity has no downwards velocity*
 
-						for (auto velocity : velocityview) {
-							auto& velocitydata{ registry.get<VelocityComponent>(velocity) };
-							auto& positiondata{ registry.get<SpatialComponent>(velocity) };
-
-							for (auto floor : floorview) {
+						for (auto [velocity, velocitydata, positiondata] : velocityview.each()) {
+							for (auto [floor, floordata] : floorview.each()) {
 								if (velocity != floor) {
-									auto& floordata{ registry.get<SpatialComponent>(floor) };
-
 									if (collideAt(positiondata, floordata, Vector2D{ 0, 1 })) {
 										velocitydata.y = 0;
 									}
@@ -861,17 +4034,14 @@ int main(int argc, char *argv[]) {
 
 					// Headbounce System
 					{
+						auto timer{ watchdog.measure("Headbounce System") };
+
 						auto velocityview{ registry.view<VelocityComponent, SpatialComponent>() };
 						auto ceilingview{ registry.view<SpatialComponent>() };
 
-						for (auto velocity : velocityview) {
-							auto& velocitydata{ registry.get<VelocityComponent>(velocity) };
-							auto& positiondata{ registry.get<SpatialComponent>(velocity) };
-
-							for (auto ceiling : ceilingview) {
+						for (auto [velocity, velocitydata, positiondata] : velocityview.each()) {
+							for (auto [ceiling, ceilingdata] : ceilingview.each()) {
 								if (velocity != ceiling) {
-									auto& ceilingdata{ registry.get<SpatialComponent>(ceiling) };
-
 									if (collideAt(positiondata, ceilingdata, Vector2D{ 0, -1 })) {
 										velocitydata.y = 0;
 									}
@@ -880,39 +4050,25 @@ int main(int argc, char *argv[]) {
 						}
 					}
 
-					// Coin Collection System
+					// Trigger System (detects overlaps, then lets the handlers react to them)
 					{
-						auto playerview{ registry.view<SpatialComponent, AccumulatorComponent>() };
-						auto coinview{ registry.view<CollectableComponent>() };
-
-						for (auto player : playerview) {
-							auto& playerdata{ registry.get<SpatialComponent>(player) };
-
-							for (auto coin : coinview) {
-								auto& coindata{ registry.get<CollectableComponent>(coin) };
+						auto timer{ watchdog.measure("Trigger System") };
 
-								SpatialComponent coinspatial{ coindata.x, coindata.y, coindata.w, coindata.h };
-
-								if (collideAt(playerdata, coinspatial)) {
-									std::cout << "Coins: " << ++registry.get<AccumulatorComponent>(player).coins << '\n';
-									Random::randomizeCoinLocation(registry, worldwidth, worldheight, worldscale * tilesize);
-								}
-							}
-						}
+						triggertracker.detect(registry, triggerindex, dispatcher);
+						dispatcher.update();
 					}
 				}
 
 				// Visual System
 				{
-					auto view{ registry.view<VisualComponent, SpatialComponent>() };
+					auto timer{ watchdog.measure("Visual System") };
 
-					// *Perceivable and material entities have their visual component alligned with their spatial component*
+					auto view{ registry.view<MovedComponent, VisualComponent, SpatialComponent>() };
 
-					for (auto entity : view)
-					{
-						auto& visual{ registry.get<VisualComponent>(entity) };
-						const auto& spatial{ registry.get<SpatialComponent>(entity) };
+					// *Perceivable and material entities that moved have their visual component alligned with their spatial component*
 
+					for (auto [entity, visual, spatial] : view.each())
+					{
 						visual.dstRect.x = spatial.x;
 						visual.dstRect.y = spatial.y;
 					}
@@ -920,112 +4076,266 @@ int main(int argc, char *argv[]) {
 
 				// Coin Visual System
 				{
-					auto view{ registry.view<VisualComponent, CollectableComponent>() };
+					auto timer{ watchdog.measure("Coin Visual System") };
 
-					// *Perceivable and collectable entities have their visual component alligned with their collectable component*
+					auto view{ registry.view<MovedComponent, VisualComponent, CollectableComponent>() };
 
-					for (auto entity : view)
-					{
-						auto& visual{ registry.get<VisualComponent>(entity) };
-						const auto& collectable{ registry.get<CollectableComponent>(entity) };
+					// *Perceivable and collectable entities that moved have their visual component alligned with their collectable component*
 
+					for (auto [entity, visual, collectable] : view.each())
+					{
 						visual.dstRect.x = collectable.x;
 						visual.dstRect.y = collectable.y;
 					}
 				}
+
+				// Animation System (advances every animator and writes its frame to the visual)
+				{
+					auto timer{ watchdog.measure("Animation System") };
+
+					Animation::update(registry, clips);
+				}
+
+				registry.clear<MovedComponent>();
+
+				// Camera System
+				{
+					auto timer{ watchdog.measure("Camera System") };
+
+					auto view{ registry.view<CameraComponent>() };
+
+					// *Cameras center on their target and never show anything outside the world*
+
+					for (auto entity : view)
+					{
+						auto& cameradata{ registry.get<CameraComponent>(entity) };
+
+						if (registry.valid(cameradata.target) && registry.all_of<SpatialComponent>(cameradata.target)) {
+							const auto& spatial{ registry.get<SpatialComponent>(cameradata.target) };
+
+							cameradata.x = spatial.x + spatial.w / 2 - cameradata.w / 2;
+							cameradata.y = spatial.y + spatial.h / 2 - cameradata.h / 2;
+						}
+
+						cameradata.x = std::clamp(cameradata.x, 0, std::max(0, tilesize * worldscale * worldwidth - cameradata.w));
+						cameradata.y = std::clamp(cameradata.y, 0, std::max(0, tilesize * worldscale * worldheight - cameradata.h));
+					}
+				}
 			}
 
 			// Render System
 			{
+				auto timer{ watchdog.measure("Render System") };
+				auto renderstart{ std::chrono::steady_clock::now() };
+
 				SDL_RenderClear(renderer);
+				++drawcalls;
 
-				auto view{ registry.view<VisualComponent>() };
+				const auto& cameradata{ registry.get<CameraComponent>(camera) };
+				SDL_Rect viewport{ cameradata.x, cameradata.y, cameradata.w, cameradata.h };
 
-				for (auto entity : view) {
-					auto& visual{ registry.get<VisualComponent>(entity) };
+				// Tiles are looked up through the level grid, so only the cells under the viewport are visited
 
-					SDL_RenderCopyEx(renderer, textures.at(visual.texture), &visual.srcRect, &visual.dstRect, 0, nullptr, visual.flip);
+				{
+					int tilepixels{ tilesize * worldscale };
+					int firstcol{ std::max(0, viewport.x / tilepixels) };
+					int firstrow{ std::max(0, viewport.y / tilepixels) };
+					int lastcol{ std::min(worldwidth - 1, (viewport.x + viewport.w - 1) / tilepixels) };
+					int lastrow{ std::min(worldheight - 1, (viewport.y + viewport.h - 1) / tilepixels) };
+
+					for (int tilerow{ firstrow }; tilerow <= lastrow; ++tilerow) {
+						for (int tilecol{ firstcol }; tilecol <= lastcol; ++tilecol) {
+							auto tile{ tileentities[static_cast<std::size_t>(tilerow) * worldwidth + tilecol] };
+
+							if (tile != entt::null) {
+								auto& visual{ registry.get<VisualComponent>(tile) };
+								SDL_Rect dstRect{ visual.dstRect.x - viewport.x, visual.dstRect.y - viewport.y, visual.dstRect.w, visual.dstRect.h };
+
+								SDL_RenderCopyEx(renderer, textures.at(visual.texture), &visual.srcRect, &dstRect, 0, nullptr, visual.flip);
+								++drawcalls;
+							}
+						}
+					}
 				}
 
+				// Everything else (player, coins, movers) is tagged as a sprite and few enough to cull one by one, the view walks only the sprites
 
+				auto view{ registry.view<SpriteComponent, VisualComponent>() };
 
-				// Debug (visualizes certain values for certain entities)
-
-				auto viewDebugStatic{ registry.view<SpatialComponent, DebugComponent>(entt::exclude<VelocityComponent>) };
+				for (auto [entity, visual] : view.each()) {
+					if (SDL_HasIntersection(&visual.dstRect, &viewport)) {
+						SDL_Rect dstRect{ visual.dstRect.x - viewport.x, visual.dstRect.y - viewport.y, visual.dstRect.w, visual.dstRect.h };
 
-				for (auto entity : viewDebugStatic) {
-					auto& debug{ registry.get<DebugComponent>(entity) };
-					auto& spatial{ registry.get<SpatialComponent>(entity) };
-
-					if (debug.toggle) {
-						SDL_SetRenderDrawColor(renderer, 255, 255, 0, 100);
-						SDL_Rect box{ spatial.x, spatial.y, spatial.w, spatial.h };
-						SDL_RenderFillRect(renderer, &box);
+						SDL_RenderCopyEx(renderer, textures.at(visual.texture), &visual.srcRect, &dstRect, 0, nullptr, visual.flip);
+						++drawcalls;
 					}
 				}
 
-				auto viewDebugCoin{ registry.view<CollectableComponent, DebugComponent>() };
 
-				for (auto entity : viewDebugCoin) {
-					auto& debug{ registry.get<DebugComponent>(entity) };
-					auto& collectable{ registry.get<CollectableComponent>(entity) };
 
-					if (debug.toggle) {
-						SDL_SetRenderDrawColor(renderer, 255, 0, 255, 100);
-						SDL_Rect box{ collectable.x, collectable.y, collectable.w, collectable.h };
-						SDL_RenderFillRect(renderer, &box);
+				// Debug (visualizes certain values for certain entities). Everything is gathered into the overlay first and drawn with one call per color
+
+				if (isDebugging) {
+					overlay.clear();
+
+					// Collidable tiles are found through the level grid like when rendering them
+
+					{
+						int tilepixels{ tilesize * worldscale };
+						int firstcol{ std::max(0, viewport.x / tilepixels) };
+						int firstrow{ std::max(0, viewport.y / tilepixels) };
+						int lastcol{ std::min(worldwidth - 1, (viewport.x + viewport.w - 1) / tilepixels) };
+						int lastrow{ std::min(worldheight - 1, (viewport.y + viewport.h - 1) / tilepixels) };
+
+						for (int tilerow{ firstrow }; tilerow <= lastrow; ++tilerow) {
+							for (int tilecol{ firstcol }; tilecol <= lastcol; ++tilecol) {
+								auto tile{ tileentities[static_cast<std::size_t>(tilerow) * worldwidth + tilecol] };
+
+								if (tile != entt::null && registry.all_of<DebugComponent>(tile)) {
+									const auto& spatial{ registry.get<SpatialComponent>(tile) };
+									overlay.colliders.push_back(SDL_Rect{ spatial.x - viewport.x, spatial.y - viewport.y, spatial.w, spatial.h });
+								}
+							}
+						}
 					}
-				}
 
-				auto viewDebug{ registry.view<SpatialComponent, VelocityComponent, DebugComponent>() };
+					auto viewDebugCoin{ registry.view<CollectableComponent, DebugComponent>() };
 
-				for (auto entity : viewDebug) {
-					auto& debug{ registry.get<DebugComponent>(entity) };
-					auto& spatial{ registry.get<SpatialComponent>(entity) };
-					auto& velocity{ registry.get<VelocityComponent>(entity) };
+					for (auto [entity, collectable] : viewDebugCoin.each()) {
+						SDL_Rect box{ collectable.x, collectable.y, collectable.w, collectable.h };
 
-					if (debug.toggle) {
-						SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+						if (SDL_HasIntersection(&box, &viewport)) {
+							overlay.collectables.push_back(SDL_Rect{ box.x - viewport.x, box.y - viewport.y, box.w, box.h });
+						}
+					}
 
-						// X Axis Position
-						SDL_SetRenderDrawColor(renderer, 255, 0, 0, 100);
-						SDL_Rect xBox{ spatial.x, 0, spatial.w, 5 };
-						SDL_RenderFillRect(renderer, &xBox);
+					auto viewDebug{ registry.view<SpatialComponent, VelocityComponent, DebugComponent>() };
 
-						// Y Axis Position
-						SDL_SetRenderDrawColor(renderer, 0, 0, 255, 100);
-						SDL_Rect yBox{ 0, spatial.y, 5, spatial.h };
-						SDL_RenderFillRect(renderer, &yBox);
+					for (auto [entity, spatial, velocity] : viewDebug.each()) {
+						int x{ spatial.x - viewport.x };
+						int y{ spatial.y - viewport.y };
 
-						// Collision Box
-						SDL_SetRenderDrawColor(renderer, 0, 255, 0, 100);
-						SDL_Rect cBox{ spatial.x, spatial.y, spatial.w, spatial.h };
-						SDL_RenderFillRect(renderer, &cBox);
+						// X Axis Position, Y Axis Position and Collision Box
+						overlay.xaxes.push_back(SDL_Rect{ x, 0, spatial.w, 5 });
+						overlay.yaxes.push_back(SDL_Rect{ 0, y, 5, spatial.h });
+						overlay.bodies.push_back(SDL_Rect{ x, y, spatial.w, spatial.h });
 
 						// Velocity Line
-						SDL_SetRenderDrawColor(renderer, 0, 255, 255, 255);
-						int x1{ spatial.x + static_cast<int>(std::round(spatial.w / 2.0)) };
-						int y1{ spatial.y + static_cast<int>(std::round(spatial.h / 2.0)) };
+						int x1{ x + static_cast<int>(std::round(spatial.w / 2.0)) };
+						int y1{ y + static_cast<int>(std::round(spatial.h / 2.0)) };
 						int x2{ static_cast<int>(std::round(x1 + velocity.x * 3)) };
 						int y2{ static_cast<int>(std::round(y1 + velocity.y * 3)) };
-						SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
+						overlay.velocities.push_back(SDL_Point{ x1, y1 });
+						overlay.velocities.push_back(SDL_Point{ x2, y2 });
+					}
+
+					// Memory (one row per component pool in the top right corner, scaled to the largest pool: reserved bytes and the share in use, then the allocations of the last frame at a pixel each)
+
+					{
+						// The report is refreshed twice a second rather than every frame (and on toggling debug on, see the Input System)
+
+						if (renderedframes % 20 == 0) {
+							accounting.refresh(lastframe);
+						}
+
+						const auto& report{ accounting.report() };
+
+						std::size_t largest{ 1 };
+						for (const auto& pool : report.pools) {
+							largest = std::max(largest, pool.bytes());
+						}
+
+						constexpr int barwidth{ 200 };
+						constexpr int barheight{ 6 };
+						int x{ viewport.w - barwidth - 10 };
+						int y{ 10 };
+
+						for (const auto& pool : report.pools) {
+							int reserved{ static_cast<int>(pool.bytes() * barwidth / largest) };
+							int used{ pool.capacity ? static_cast<int>(reserved * pool.size / pool.capacity) : 0 };
+
+							overlay.poolcapacities.push_back(SDL_Rect{ x, y, reserved, barheight });
+							overlay.poolsizes.push_back(SDL_Rect{ x, y, used, barheight });
+
+							y += barheight + 2;
+						}
+
+						overlay.frameallocations.push_back(SDL_Rect{ x, y + barheight, static_cast<int>(std::min<std::size_t>(report.frame.allocations, barwidth)), barheight });
+					}
+
+					SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+					drawcalls += fillRects(renderer, overlay.colliders, SDL_Color{ 255, 255, 0, 100 });
+					drawcalls += fillRects(renderer, overlay.collectables, SDL_Color{ 255, 0, 255, 100 });
+					drawcalls += fillRects(renderer, overlay.xaxes, SDL_Color{ 255, 0, 0, 100 });
+					drawcalls += fillRects(renderer, overlay.yaxes, SDL_Color{ 0, 0, 255, 100 });
+					drawcalls += fillRects(renderer, overlay.bodies, SDL_Color{ 0, 255, 0, 100 });
+					drawcalls += fillRects(renderer, overlay.poolcapacities, SDL_Color{ 128, 128, 128, 150 });
+					drawcalls += fillRects(renderer, overlay.poolsizes, SDL_Color{ 0, 255, 0, 200 });
+					drawcalls += fillRects(renderer, overlay.frameallocations, SDL_Color{ 255, 64, 64, 200 });
+
+					// SDL_RenderDrawLines draws one connected strip, so the disjoint velocity lines only share their draw color
+
+					SDL_SetRenderDrawColor(renderer, 0, 255, 255, 255);
+					for (std::size_t i{ 0 }; i + 1 < overlay.velocities.size(); i += 2) {
+						SDL_RenderDrawLines(renderer, &overlay.velocities[i], 2);
+						++drawcalls;
 					}
 				}
 
 				SDL_RenderPresent(renderer);
+				rendertime += std::chrono::steady_clock::now() - renderstart;
+
+				if (isOffscreen && !framedirectory.empty()) {
+					std::string number{ std::to_string(renderedframes) };
+					std::string framefile{ framedirectory + "/frame_" + std::string(number.size() < 5 ? 5 - number.size() : 0, '0') + number + ".png" };
+
+					if (IMG_SavePNG(surface, framefile.c_str()) != 0) {
+						std::cerr << "IMG_SavePNG(): " << IMG_GetError() << '\n';
+					}
+				}
 			}
 
-			// End Condition (also prints the time since the program started)
+			// Script System (resumes the behaviors that are due, e.g. the end condition)
 			{
-				if (registry.get<AccumulatorComponent>(player).coins >= coinsToWin) {
-					std::cout << "Time: " << SDL_GetTicks64() / 1000.0 << '\n';
+				auto timer{ watchdog.measure("Script System") };
+				scheduler.tick();
+			}
+
+			// Off-screen runs render as fast as they can, their frame times are reported at the end instead
+
+			if (!isOffscreen) {
+				watchdog.endFrame(config.framebudget, [&](std::ostream& out) {
+					out << "\tvisual\t" << registry.storage<VisualComponent>().size() << '\n'
+						<< "\tspatial\t" << registry.storage<SpatialComponent>().size() << '\n'
+						<< "\tmovers\t" << Physics::bodies(registry).size() << '\n'
+						<< "\ttriggers\t" << registry.storage<TriggerComponent>().size() << '\n'
+						<< "\tbehaviors\t" << scheduler.size() << '\n';
+				});
+			}
+
+			lastframe = Memory::counts() - framestart;
+
+			++renderedframes;
+
+			// pause the game for 25 ticks (completely arbitrary). Off-screen runs go as fast as they can and stop after their frames
+
+			if (isOffscreen) {
+				if (renderedframes >= offscreenframes) {
 					isRunning = false;
 				}
 			}
+			else {
+				SDL_Delay(25);
+			}
+		}
 
-			// pause the game for 25 ticks (completely arbitrary)
+		if (isOffscreen) {
+			std::chrono::duration<double, std::milli> runtime{ std::chrono::steady_clock::now() - runstart };
 
-			SDL_Delay(25);
+			std::cout << linebreak
+				<< "frames\t\tdraw calls/frame\trender (ms/frame)\tframe (ms/frame)\n"
+				<< renderedframes << "\t\t" << static_cast<double>(drawcalls) / renderedframes << "\t\t\t" << rendertime.count() / renderedframes << "\t\t\t" << runtime.count() / renderedframes << '\n';
 		}
 
 		std::cout << linebreak;
@@ -1047,6 +4357,11 @@ int main(int argc, char *argv[]) {
 			std::cout << "Window destroyed...\n";
 		}
 
+		if (surface) {
+			SDL_FreeSurface(surface);
+			std::cout << "Surface destroyed...\n";
+		}
+
 		std::cout << linebreak;
 
 		// <QUIT>